@@ -0,0 +1,34 @@
+#include "benchmark.hpp"
+
+namespace neat::bench {
+
+benchmark_runner::benchmark_runner(const benchmark_config_t& config, std::ostream& out) :
+	m_config{ config }, m_out{ out } {
+	if (m_config.format == output_format_t::csv) {
+		m_out << "name,parameters,iterations,ops_per_iteration,ns_per_op,ops_per_second\n";
+	}
+}
+
+bool benchmark_runner::is_enabled(const std::string_view name) const {
+	return m_config.filter.empty() or name.find(m_config.filter) != std::string_view::npos;
+}
+
+void benchmark_runner::report(const benchmark_result_t& result) {
+	if (m_config.format == output_format_t::csv) {
+		m_out << result.name << ",\"" << result.parameters << "\"," << result.iterations << ','
+			  << result.ops_per_iteration << ',' << result.ns_per_op << ',' << result.ops_per_second << '\n';
+	} else {
+		m_out << "{\"name\":\"" << result.name << "\",\"parameters\":\"" << result.parameters
+			  << "\",\"iterations\":" << result.iterations << ",\"ops_per_iteration\":" << result.ops_per_iteration
+			  << ",\"ns_per_op\":" << result.ns_per_op << ",\"ops_per_second\":" << result.ops_per_second << "}\n";
+	}
+	m_out.flush();
+
+	m_results.push_back(result);
+}
+
+const debug_vector<benchmark_result_t>& benchmark_runner::results() const {
+	return m_results;
+}
+
+} // namespace neat::bench
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat::bench {
+
+enum class output_format_t : std::uint8_t { json, csv };
+
+struct benchmark_config_t {
+	std::chrono::milliseconds min_time{ 200 };
+	std::uint32_t min_iterations{ 3 };
+	std::string filter{};
+	output_format_t format{ output_format_t::json };
+};
+
+struct benchmark_result_t {
+	std::string name;
+	// Free form description of the benchmark parameters, e.g. "networks=1000 connections=32".
+	std::string parameters;
+	std::uint64_t iterations{};
+	// Operations done per iteration, the unit depends on the benchmark (networks, connections, birds, ...).
+	std::uint64_t ops_per_iteration{};
+	double ns_per_op{};
+	double ops_per_second{};
+};
+
+// Keeps the compiler from discarding computations whose results are otherwise unused.
+template<typename T>
+inline void do_not_optimize(const T& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class benchmark_runner {
+public:
+	benchmark_runner(const benchmark_config_t& config, std::ostream& out);
+
+	[[nodiscard]] bool is_enabled(std::string_view name) const;
+
+	// Calls `setup` before and `iteration` timed in a loop, until both the minimum time and iteration count are
+	// reached. The fastest iteration is reported to filter out scheduling noise.
+	template<typename Setup, typename Iteration>
+	void run(
+		std::string_view name,
+		std::string_view parameters,
+		std::uint64_t ops_per_iteration,
+		Setup&& setup,
+		Iteration&& iteration
+	);
+
+	void report(const benchmark_result_t& result);
+
+	[[nodiscard]] const debug_vector<benchmark_result_t>& results() const;
+
+private:
+	benchmark_config_t m_config;
+	std::ostream& m_out;
+	debug_vector<benchmark_result_t> m_results;
+};
+
+template<typename Setup, typename Iteration>
+void benchmark_runner::run(
+	const std::string_view name,
+	const std::string_view parameters,
+	const std::uint64_t ops_per_iteration,
+	Setup&& setup,
+	Iteration&& iteration
+) {
+	if (not is_enabled(name)) {
+		return;
+	}
+
+	using clock_t = std::chrono::steady_clock;
+
+	auto best_time = clock_t::duration::max();
+	auto total_time = clock_t::duration{};
+	auto iterations = std::uint64_t{};
+
+	while (iterations < m_config.min_iterations or total_time < m_config.min_time) {
+		setup();
+		const auto begin = clock_t::now();
+		iteration();
+		const auto time = clock_t::now() - begin;
+
+		best_time = std::min(best_time, time);
+		total_time += time;
+		++iterations;
+	}
+
+	const auto best_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(best_time).count());
+	const auto ops = static_cast<double>(std::max(ops_per_iteration, std::uint64_t{ 1 }));
+
+	report({ .name = std::string(name),
+	         .parameters = std::string(parameters),
+	         .iterations = iterations,
+	         .ops_per_iteration = ops_per_iteration,
+	         .ns_per_op = best_ns / ops,
+	         .ops_per_second = best_ns == 0.0 ? 0.0 : ops * 1e9 / best_ns });
+}
+
+} // namespace neat::bench
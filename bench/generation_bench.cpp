@@ -0,0 +1,322 @@
+#include "generation_bench.hpp"
+
+#include "headless_flappy_birds.hpp"
+#include "heap_counter.hpp"
+#include "neat/trainer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace neat::bench {
+
+static debug_vector<std::uint32_t> default_thread_counts() {
+	const auto hardware_thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+
+	debug_vector<std::uint32_t> thread_counts;
+	for (auto thread_count = 1u; thread_count < hardware_thread_count; thread_count *= 2) {
+		thread_counts.push_back(thread_count);
+	}
+	thread_counts.push_back(hardware_thread_count);
+
+	return thread_counts;
+}
+
+static void write_result(std::ostream& out, const output_format_t format, const generation_bench_result_t& result) {
+	if (format == output_format_t::csv) {
+		out << result.population_size << ',' << result.thread_count << ',' << result.generation_count << ','
+			<< result.evolve_time.count() << ',' << result.max_evolve_time.count() << ','
+			<< result.evaluation_time.count() << ',' << result.frame_count << ',' << result.evaluation_count << ','
+			<< result.steady_state_arena_allocation_count << ',' << result.steady_state_heap_allocation_count << ','
+			<< result.migrated_worker_count << ','
+			<< result.failed_placement_count << ',' << result.explicit_hugepage_bytes << ','
+			<< result.transparent_hugepage_bytes << ',' << result.small_page_bytes << ','
+			<< result.replacement_count << ',' << result.generations_per_second << ','
+			<< result.frames_per_second << ',' << result.evaluations_per_second << ','
+			<< result.replacements_per_second << ',' << result.parallel_efficiency << '\n';
+	} else {
+		out << "{\"population_size\":" << result.population_size << ",\"thread_count\":" << result.thread_count
+			<< ",\"generation_count\":" << result.generation_count
+			<< ",\"evolve_time_ns\":" << result.evolve_time.count()
+			<< ",\"max_evolve_time_ns\":" << result.max_evolve_time.count()
+			<< ",\"evaluation_time_ns\":" << result.evaluation_time.count()
+			<< ",\"frame_count\":" << result.frame_count << ",\"evaluation_count\":" << result.evaluation_count
+			<< ",\"steady_state_arena_allocation_count\":" << result.steady_state_arena_allocation_count
+			<< ",\"steady_state_heap_allocation_count\":" << result.steady_state_heap_allocation_count
+			<< ",\"migrated_worker_count\":" << result.migrated_worker_count
+			<< ",\"failed_placement_count\":" << result.failed_placement_count
+			<< ",\"explicit_hugepage_bytes\":" << result.explicit_hugepage_bytes
+			<< ",\"transparent_hugepage_bytes\":" << result.transparent_hugepage_bytes
+			<< ",\"small_page_bytes\":" << result.small_page_bytes
+			<< ",\"replacement_count\":" << result.replacement_count
+			<< ",\"generations_per_second\":" << result.generations_per_second
+			<< ",\"frames_per_second\":" << result.frames_per_second
+			<< ",\"evaluations_per_second\":" << result.evaluations_per_second
+			<< ",\"replacements_per_second\":" << result.replacements_per_second
+			<< ",\"parallel_efficiency\":" << result.parallel_efficiency << "}\n";
+	}
+	out.flush();
+}
+
+static void store_mapped_bytes(const hugepage_stats_t& hugepage_stats_begin, generation_bench_result_t& result) {
+	const auto hugepage_stats_end = hugepage_stats();
+	const auto mapped_bytes = [&](const page_backing_t backing) {
+		return hugepage_stats_end.byte_count(backing) - hugepage_stats_begin.byte_count(backing);
+	};
+	result.explicit_hugepage_bytes = mapped_bytes(page_backing_t::explicit_hugepages);
+	result.transparent_hugepage_bytes = mapped_bytes(page_backing_t::transparent_hugepages);
+	result.small_page_bytes = mapped_bytes(page_backing_t::small_pages);
+}
+
+static generation_bench_result_t run_generations(
+	const generation_bench_config_t& config, const std::uint32_t population_size, const std::uint32_t thread_count
+) {
+	using clock_t = std::chrono::steady_clock;
+
+	// Taken before the trainer allocates its populations.
+	const auto hugepage_stats_begin = hugepage_stats();
+
+	const auto interface_config = network_interface_config_t{ .input_count = headless_flappy_birds::input_count,
+		                                                      .output_count = headless_flappy_birds::output_count };
+
+	trainer flappy_trainer(
+		evolution_config_t{ .connectivity = config.connectivity },
+		interface_config,
+		population_size,
+		thread_count,
+		config.seed,
+		config.execution_config
+	);
+	inference::types::network_group_t network_group;
+	inference::types::network_group_t reordered_network_group;
+	inference::types::shared_input_network_group_t shared_input_network_group;
+	const auto shared_input_layout = headless_flappy_birds::input_layout();
+	const auto shared_inputs = config.shared_inputs and config.connectivity == connectivity_t::feed_forward;
+	debug_vector<types::network_index_t> original_network_indices;
+	debug_vector<types::fitness_t> reordered_fitness(population_size);
+
+	auto game = headless_flappy_birds(
+		flappy_birds::game_logic::config_t{},
+		population_size,
+		config.seed,
+		config.connectivity
+	);
+
+	debug_vector<types::fitness_t> fitness(population_size, 0.0f);
+
+	auto result = generation_bench_result_t{ .population_size = population_size,
+		                                     .thread_count = thread_count,
+		                                     .generation_count = config.generation_count };
+
+	for (std::uint32_t i{}; i != config.generation_count; ++i) {
+		const auto heap_allocation_count_begin = heap_allocation_count();
+		const auto evolve_begin = clock_t::now();
+		flappy_trainer.evolve(fitness, network_group);
+		const auto evaluation_begin = clock_t::now();
+		const auto evolve_heap_allocation_count = heap_allocation_count() - heap_allocation_count_begin;
+
+		std::fill(fitness.begin(), fitness.end(), 0.0f);
+		auto game_stats = game_stats_t{};
+		if (config.network_order) {
+			inference::reorder_network_group(
+				network_group,
+				interface_config,
+				*config.network_order,
+				reordered_network_group,
+				original_network_indices
+			);
+
+			// The workers are placed by population index, which no longer matches the reordered networks.
+			std::fill(reordered_fitness.begin(), reordered_fitness.end(), 0.0f);
+			game_stats = game.play(
+				reordered_network_group,
+				thread_count,
+				config.max_frame_count,
+				1.0f,
+				reordered_fitness
+			);
+
+			for (std::size_t j{}; j != reordered_fitness.size(); ++j) {
+				fitness[original_network_indices[j]] = reordered_fitness[j];
+			}
+		} else if (shared_inputs) {
+			inference::compile_shared_input_network_group(
+				network_group,
+				interface_config,
+				shared_input_layout,
+				shared_input_network_group
+			);
+			game_stats = game.play(
+				shared_input_network_group,
+				thread_count,
+				config.max_frame_count,
+				1.0f,
+				fitness,
+				&flappy_trainer
+			);
+		} else {
+			game_stats = game.play(network_group, thread_count, config.max_frame_count, 1.0f, fitness, &flappy_trainer);
+		}
+		const auto evaluation_end = clock_t::now();
+
+		result.evolve_time += evaluation_begin - evolve_begin;
+		result.max_evolve_time = std::max(
+			result.max_evolve_time,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(evaluation_begin - evolve_begin)
+		);
+		result.evaluation_time += evaluation_end - evaluation_begin;
+		result.frame_count += game_stats.frame_count;
+		result.evaluation_count += game_stats.evaluation_count;
+		const auto& generation_stats = flappy_trainer.last_generation_stats();
+		for (const auto& phase_stats : generation_stats.phases) {
+			result.migrated_worker_count += phase_stats.migrated_worker_count;
+		}
+		result.failed_placement_count += generation_stats.placement.failed_placement_count;
+
+		// The first generation sizes the arena and the second one merges its blocks.
+		if (i > 1) {
+			result.steady_state_arena_allocation_count += flappy_trainer.last_generation_stats()
+			                                                  .arena.upstream_allocation_count;
+			result.steady_state_heap_allocation_count += evolve_heap_allocation_count;
+		}
+	}
+
+	store_mapped_bytes(hugepage_stats_begin, result);
+
+	const auto seconds = std::chrono::duration<double>(result.evolve_time + result.evaluation_time).count();
+	const auto evaluation_seconds = std::chrono::duration<double>(result.evaluation_time).count();
+
+	if (seconds > 0.0) {
+		result.generations_per_second = static_cast<double>(result.generation_count) / seconds;
+	}
+	if (evaluation_seconds > 0.0) {
+		result.frames_per_second = static_cast<double>(result.frame_count) / evaluation_seconds;
+		result.evaluations_per_second = static_cast<double>(result.evaluation_count) / evaluation_seconds;
+	}
+
+	return result;
+}
+
+static generation_bench_result_t run_steady_state(
+	const generation_bench_config_t& config, const std::uint32_t population_size, const std::uint32_t thread_count
+) {
+	using clock_t = std::chrono::steady_clock;
+
+	const auto hugepage_stats_begin = hugepage_stats();
+
+	const auto interface_config = network_interface_config_t{ .input_count = headless_flappy_birds::input_count,
+		                                                      .output_count = headless_flappy_birds::output_count };
+
+	trainer flappy_trainer(
+		evolution_config_t{ .connectivity = config.connectivity },
+		interface_config,
+		population_size,
+		thread_count,
+		config.seed,
+		config.execution_config
+	);
+
+	auto result = generation_bench_result_t{ .population_size = population_size, .thread_count = thread_count };
+
+	std::atomic<std::uint64_t> frame_count{};
+	std::atomic<std::uint64_t> evaluation_count{};
+
+	debug_vector<std::thread> threads;
+	threads.reserve(thread_count);
+
+	const auto begin = clock_t::now();
+	flappy_trainer.begin_steady_state();
+
+	// Every thread reports its own games, so the replacements of one thread overlap with the games of the others.
+	for (std::uint32_t i{}; i != thread_count; ++i) {
+		threads.emplace_back([&, i]() {
+			auto game = headless_flappy_birds(
+				flappy_birds::game_logic::config_t{},
+				1,
+				config.seed + i,
+				config.connectivity
+			);
+			auto fitness = std::array<types::fitness_t, 1>{};
+			auto thread_stats = game_stats_t{};
+
+			auto network = flappy_trainer.acquire_network();
+			while (network and flappy_trainer.steady_state_replacement_count() < config.replacement_count) {
+				fitness.front() = 0.0f;
+				const auto game_stats = game.play(*network->network_group, 1, config.max_frame_count, 1.0f, fitness);
+				thread_stats.frame_count += game_stats.frame_count;
+				thread_stats.evaluation_count += game_stats.evaluation_count;
+
+				network = flappy_trainer.report_fitness(network->index, fitness.front());
+			}
+
+			frame_count += thread_stats.frame_count;
+			evaluation_count += thread_stats.evaluation_count;
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	const auto end = clock_t::now();
+
+	result.evaluation_time = end - begin;
+	result.frame_count = frame_count;
+	result.evaluation_count = evaluation_count;
+	result.replacement_count = flappy_trainer.steady_state_replacement_count();
+
+	store_mapped_bytes(hugepage_stats_begin, result);
+
+	const auto seconds = std::chrono::duration<double>(result.evaluation_time).count();
+	if (seconds > 0.0) {
+		result.frames_per_second = static_cast<double>(result.frame_count) / seconds;
+		result.evaluations_per_second = static_cast<double>(result.evaluation_count) / seconds;
+		result.replacements_per_second = static_cast<double>(result.replacement_count) / seconds;
+	}
+
+	return result;
+}
+
+debug_vector<generation_bench_result_t> run_generation_benchmarks(
+	const generation_bench_config_t& config, std::ostream& out
+) {
+	auto thread_counts = config.thread_counts.empty() ? default_thread_counts() : config.thread_counts;
+	std::sort(thread_counts.begin(), thread_counts.end());
+
+	if (config.format == output_format_t::csv) {
+		out << "population_size,thread_count,generation_count,evolve_time_ns,max_evolve_time_ns,evaluation_time_ns,"
+			   "frame_count,evaluation_count,steady_state_arena_allocation_count,steady_state_heap_allocation_count,"
+			   "migrated_worker_count,"
+			   "failed_placement_count,explicit_hugepage_bytes,transparent_hugepage_bytes,small_page_bytes,"
+			   "replacement_count,generations_per_second,frames_per_second,evaluations_per_second,"
+			   "replacements_per_second,parallel_efficiency\n";
+	}
+
+	debug_vector<generation_bench_result_t> results;
+
+	for (const auto& population_size : config.population_sizes) {
+		const auto baseline_index = results.size();
+
+		for (const auto& thread_count : thread_counts) {
+			auto result = config.steady_state ? run_steady_state(config, population_size, thread_count)
+			                                  : run_generations(config, population_size, thread_count);
+
+			const auto throughput = [&](const generation_bench_result_t& measured) {
+				return config.steady_state ? measured.replacements_per_second : measured.generations_per_second;
+			};
+
+			const auto& baseline = results.size() == baseline_index ? result : results[baseline_index];
+			if (throughput(baseline) > 0.0) {
+				result.parallel_efficiency = (throughput(result) / throughput(baseline)) *
+					(static_cast<double>(baseline.thread_count) / static_cast<double>(result.thread_count));
+			}
+
+			write_result(out, config.format, result);
+			results.push_back(result);
+		}
+	}
+
+	return results;
+}
+
+} // namespace neat::bench
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "benchmark.hpp"
+#include "neat/evolution_config.hpp"
+#include "neat/execution_config.hpp"
+#include "neat/network_group_order.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <optional>
+#include <ostream>
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat::bench {
+
+struct generation_bench_config_t {
+	debug_vector<std::uint32_t> population_sizes{ 1'000, 10'000, 100'000, 1'000'000 };
+	// Defaults to powers of two up to and including the hardware concurrency if left empty.
+	debug_vector<std::uint32_t> thread_counts{};
+	std::uint32_t generation_count{ 10 };
+	// Games are cut off after this many frames, so good populations can't stall the benchmark.
+	std::uint64_t max_frame_count{ 3'600 };
+	execution_config_t execution_config{};
+	// Runs the steady state mode instead of generations. Every thread plays single bird games and reports their
+	// fitness, until the trainer replaced replacement_count networks.
+	bool steady_state{ false };
+	std::uint64_t replacement_count{ 10'000 };
+	// Recurrent birds keep their node values between frames.
+	connectivity_t connectivity{ connectivity_t::feed_forward };
+	// If set, the birds play with a reordered copy of the compiled networks, which counts as evaluation time.
+	std::optional<inference::network_order_t> network_order{};
+	// If set, feed forward birds play with the pipe distance passed once per frame and the bias folded into the
+	// node offsets. Compiling the shared input group counts as evaluation time.
+	bool shared_inputs{ false };
+	std::uint64_t seed{ 42 };
+	output_format_t format{ output_format_t::json };
+};
+
+struct generation_bench_result_t {
+	std::uint32_t population_size{};
+	std::uint32_t thread_count{};
+	std::uint32_t generation_count{};
+	std::chrono::nanoseconds evolve_time{};
+	// Slowest single evolve call, the spread to the average shows how stable the generation latency is.
+	std::chrono::nanoseconds max_evolve_time{};
+	std::chrono::nanoseconds evaluation_time{};
+	std::uint64_t frame_count{};
+	std::uint64_t evaluation_count{};
+	// Arena blocks the trainer allocated after its first two generations, zero in the steady state.
+	std::uint64_t steady_state_arena_allocation_count{};
+	// Heap allocations of the same evolve calls, by the trainer and the standard library, like the thread states.
+	std::uint64_t steady_state_heap_allocation_count{};
+	// Trainer workers that were moved to another CPU mid phase, summed over all generations.
+	std::uint64_t migrated_worker_count{};
+	std::uint64_t failed_placement_count{};
+	// Bytes of the large trainer and inference buffers mapped during the run, by the backing they got.
+	std::uint64_t explicit_hugepage_bytes{};
+	std::uint64_t transparent_hugepage_bytes{};
+	std::uint64_t small_page_bytes{};
+	// Only set in the steady state mode, which has no generations. The time is measured from begin_steady_state,
+	// so it includes evaluating the initial population.
+	std::uint64_t replacement_count{};
+	double generations_per_second{};
+	double frames_per_second{};
+	double evaluations_per_second{};
+	double replacements_per_second{};
+	// Speedup over the smallest measured thread count divided by the relative thread count.
+	double parallel_efficiency{};
+};
+
+// Runs full generations (trainer::evolve plus one headless flappy birds game), or the steady state mode, for every
+// combination of population size and thread count.
+debug_vector<generation_bench_result_t> run_generation_benchmarks(
+	const generation_bench_config_t& config, std::ostream& out
+);
+
+} // namespace neat::bench
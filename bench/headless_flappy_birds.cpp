@@ -0,0 +1,248 @@
+#include "headless_flappy_birds.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <thread>
+
+namespace neat::bench {
+
+headless_flappy_birds::headless_flappy_birds(
+	const flappy_birds::game_logic::config_t& config,
+	const std::uint32_t bird_count,
+	const std::uint64_t seed,
+	const connectivity_t connectivity
+) :
+	m_config{ config },
+	m_bird_count{ bird_count },
+	m_connectivity{ connectivity },
+	m_inputs(bird_count * input_count),
+	m_outputs(bird_count * output_count),
+	m_flap_decisions((bird_count * output_count + 63) / 64) {
+	m_state.rng.seed(seed);
+	reset();
+}
+
+void headless_flappy_birds::reset() {
+	m_state.bird_states.assign(
+		m_bird_count,
+		{ .position_y = std::lerp(m_config.floor_y, m_config.ceiling_y, 0.5f), .velocity_y = 0.0f }
+	);
+
+	m_state.active_bird_indices.resize(m_bird_count);
+	std::iota(m_state.active_bird_indices.begin(), m_state.active_bird_indices.end(), 0);
+
+	m_flaps.assign(m_bird_count, false);
+	m_state.scores.assign(m_bird_count, 0.0f);
+
+	auto gap_distrib = std::uniform_real_distribution(
+		m_config.floor_y + m_config.pipe_spacing_y / 2.0f,
+		m_config.ceiling_y - m_config.pipe_spacing_y / 2.0f
+	);
+	m_state.pipe_gaps_y.resize(m_config.pipes_behind_bird + m_config.pipes_in_front_of_bird);
+	std::generate(m_state.pipe_gaps_y.begin(), m_state.pipe_gaps_y.end(), [&]() {
+		return gap_distrib(m_state.rng);
+	});
+
+	m_state.pipe_position_x = m_config.pipe_spacing_x / 2.0f;
+	m_state.pipes_surpassed_count = 0;
+}
+
+static constexpr auto dist_gap_y_index{ 0 }, dist_pipe_x_index{ 1 }, dist_to_ceiling_y_index{ 2 },
+	dist_to_floor_y_index{ 3 }, bias_index{ 4 };
+
+inference::input_layout_t headless_flappy_birds::input_layout() {
+	auto layout = inference::input_layout_t{
+		.sources = debug_vector<inference::input_source_t>(input_count, inference::input_source_t::per_network),
+		.constant_values = debug_vector<inference::types::value_t>(input_count, 0.0f)
+	};
+	layout.sources[dist_pipe_x_index] = inference::input_source_t::shared;
+	layout.sources[bias_index] = inference::input_source_t::constant;
+	layout.constant_values[bias_index] = 1.0f;
+	return layout;
+}
+
+void headless_flappy_birds::update_inputs(const bool shared_inputs) {
+	const auto next_gap_y = m_state.pipe_gaps_y[m_config.pipes_behind_bird];
+
+	if (shared_inputs) {
+		// The per bird inputs keep their order, but the rows leave out the pipe distance and the bias.
+		static constexpr auto per_bird_input_count = std::size_t{ 3 };
+		m_shared_inputs[0] = m_state.pipe_position_x;
+
+		for (std::size_t i{}; i != m_state.bird_states.size(); ++i) {
+			const auto& bird_state = m_state.bird_states[i];
+			const auto bird_inputs = m_inputs.begin() + m_state.active_bird_indices[i] * per_bird_input_count;
+
+			bird_inputs[0] = next_gap_y - bird_state.position_y;
+			bird_inputs[1] = m_config.ceiling_y - (bird_state.position_y + m_config.bird_radius);
+			bird_inputs[2] = (bird_state.position_y - m_config.bird_radius) - m_config.floor_y;
+		}
+		return;
+	}
+
+	for (std::size_t i{}; i != m_state.bird_states.size(); ++i) {
+		const auto& bird_state = m_state.bird_states[i];
+		const auto bird_inputs = m_inputs.begin() + m_state.active_bird_indices[i] * input_count;
+
+		bird_inputs[dist_gap_y_index] = next_gap_y - bird_state.position_y;
+		bird_inputs[dist_pipe_x_index] = m_state.pipe_position_x;
+		bird_inputs[dist_to_ceiling_y_index] = m_config.ceiling_y - (bird_state.position_y + m_config.bird_radius);
+		bird_inputs[dist_to_floor_y_index] = (bird_state.position_y - m_config.bird_radius) - m_config.floor_y;
+		bird_inputs[bias_index] = 1.0f;
+	}
+}
+
+template<class EvaluateSegment>
+game_stats_t headless_flappy_birds::play_frames(
+	const std::size_t network_count,
+	const std::uint32_t thread_count,
+	const std::uint64_t max_frame_count,
+	const float fitness_scale,
+	debug_span<types::fitness_t> fitness,
+	const bool shared_inputs,
+	const bool threshold_decisions,
+	const trainer* const worker_placement,
+	const EvaluateSegment& evaluate_segment
+) {
+	static constexpr auto dt = 1.0f / 60.0f;
+
+	const auto network_range = types::network_range_t::from_index_count(0, network_count);
+
+	debug_vector<std::thread> threads;
+	threads.reserve(thread_count);
+
+	game_stats_t stats{};
+
+	auto game_over = false;
+	while (not game_over and stats.frame_count != max_frame_count) {
+		update_inputs(shared_inputs);
+
+		const auto place_and_evaluate_segment = [&](const types::network_range_t& segment) {
+			if (worker_placement) {
+				worker_placement->place_inference_worker(segment);
+			}
+			evaluate_segment(segment);
+		};
+
+		// A single segment is evaluated on the calling thread, so single bird games don't start a thread per frame.
+		if (thread_count == 1) {
+			place_and_evaluate_segment(network_range);
+		} else {
+			for (const auto& segment : network_range.balanced_segments(thread_count)) {
+				threads.emplace_back([&, segment]() { place_and_evaluate_segment(segment); });
+			}
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		threads.clear();
+
+		for (std::size_t i{}; i != m_state.active_bird_indices.size(); ++i) {
+			const auto bit = m_state.active_bird_indices[i] * output_count;
+			m_flaps[i] = threshold_decisions ? ((m_flap_decisions[bit / 64] >> (bit % 64)) & 1) != 0
+			                                 : m_outputs[bit] > 0.5f;
+		}
+
+		game_over = update(dt);
+
+		++stats.frame_count;
+		stats.evaluation_count += network_count;
+	}
+
+	for (std::size_t i{}; i != fitness.size(); ++i) {
+		fitness[i] += fitness_scale * m_state.scores[i];
+	}
+
+	return stats;
+}
+
+game_stats_t headless_flappy_birds::play(
+	const inference::types::network_group_view_t& network_group,
+	const std::uint32_t thread_count,
+	const std::uint64_t max_frame_count,
+	const float fitness_scale,
+	debug_span<types::fitness_t> fitness,
+	const trainer* const worker_placement
+) {
+	reset();
+
+	const auto recurrent = m_connectivity == connectivity_t::recurrent;
+	if (recurrent) {
+		inference::reset_recurrent_state(network_group, m_recurrent_state);
+	}
+
+	return play_frames(
+		network_group.networks.size(),
+		thread_count,
+		max_frame_count,
+		fitness_scale,
+		fitness,
+		false,
+		not recurrent,
+		worker_placement,
+		[&](const types::network_range_t& segment) {
+			if (recurrent) {
+				inference::evaluate_network_range(network_group, m_recurrent_state, m_inputs, m_outputs, segment);
+			} else {
+				inference::evaluate_network_range_threshold(
+					network_group,
+					m_inputs,
+					m_flap_decisions,
+					0.5f,
+					output_count,
+					segment
+				);
+			}
+		}
+	);
+}
+
+game_stats_t headless_flappy_birds::play(
+	const inference::types::shared_input_network_group_t& network_group,
+	const std::uint32_t thread_count,
+	const std::uint64_t max_frame_count,
+	const float fitness_scale,
+	debug_span<types::fitness_t> fitness,
+	const trainer* const worker_placement
+) {
+	assert(m_connectivity == connectivity_t::feed_forward);
+
+	reset();
+
+	const auto network_count = network_group.network_group.networks.size();
+	const auto network_inputs = debug_span<const inference::types::value_t>(
+		m_inputs.data(),
+		network_count * network_group.per_network_input_count
+	);
+
+	return play_frames(
+		network_count,
+		thread_count,
+		max_frame_count,
+		fitness_scale,
+		fitness,
+		true,
+		false,
+		worker_placement,
+		[&](const types::network_range_t& segment) {
+			inference::evaluate_network_range(network_group, m_shared_inputs, network_inputs, m_outputs, segment);
+		}
+	);
+}
+
+bool headless_flappy_birds::update(const float dt) {
+	return m_physics_engine.update(m_config, m_state, m_flaps, dt);
+}
+
+flappy_birds::game_logic::state_t& headless_flappy_birds::state() {
+	return m_state;
+}
+
+debug_vector<bool>& headless_flappy_birds::flaps() {
+	return m_flaps;
+}
+
+} // namespace neat::bench
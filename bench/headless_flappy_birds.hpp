@@ -0,0 +1,102 @@
+#pragma once
+
+#include "flappy_birds/game_logic/config.hpp"
+#include "flappy_birds/game_logic/physics_engine.hpp"
+#include "flappy_birds/game_logic/state.hpp"
+#include "neat/inference.hpp"
+#include "neat/shared_input_inference.hpp"
+#include "neat/trainer.hpp"
+
+#include <array>
+#include <cinttypes>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat::bench {
+
+struct game_stats_t {
+	std::uint64_t frame_count{};
+	// Number of single network evaluations, every network is evaluated once per frame.
+	std::uint64_t evaluation_count{};
+};
+
+// Runs the flappy birds game without rendering, with the same network inputs and flap rule as the game.
+class headless_flappy_birds {
+public:
+	static constexpr auto input_count = std::size_t{ 5 };
+	static constexpr auto output_count = std::size_t{ 1 };
+
+	// Recurrent networks are evaluated with a state that is reset at the start of every game.
+	headless_flappy_birds(
+		const flappy_birds::game_logic::config_t& config,
+		std::uint32_t bird_count,
+		std::uint64_t seed,
+		connectivity_t connectivity = connectivity_t::feed_forward
+	);
+
+	void reset();
+
+	// Plays one game until all birds crashed or max_frame_count is reached and adds the scores to fitness.
+	// If a trainer is given, the inference workers are placed next to the networks it compiled.
+	game_stats_t play(
+		const inference::types::network_group_view_t& network_group,
+		std::uint32_t thread_count,
+		std::uint64_t max_frame_count,
+		float fitness_scale,
+		debug_span<types::fitness_t> fitness,
+		const trainer* worker_placement = nullptr
+	);
+
+	// The pipe distance is the same for all birds and the bias never changes, the other inputs differ per bird.
+	[[nodiscard]] static inference::input_layout_t input_layout();
+
+	// Plays with feed forward networks compiled by compile_shared_input_network_group with input_layout,
+	// so only the per bird inputs are streamed.
+	game_stats_t play(
+		const inference::types::shared_input_network_group_t& network_group,
+		std::uint32_t thread_count,
+		std::uint64_t max_frame_count,
+		float fitness_scale,
+		debug_span<types::fitness_t> fitness,
+		const trainer* worker_placement = nullptr
+	);
+
+	bool update(float dt);
+
+	[[nodiscard]] flappy_birds::game_logic::state_t& state();
+
+	[[nodiscard]] debug_vector<bool>& flaps();
+
+private:
+	// With shared inputs, only the per bird inputs are written to the rows and the pipe distance is written once.
+	void update_inputs(bool shared_inputs);
+
+	// Runs the frames of play, evaluate_segment sets the flap decisions or the outputs of a range of birds.
+	template<class EvaluateSegment>
+	game_stats_t play_frames(
+		std::size_t network_count,
+		std::uint32_t thread_count,
+		std::uint64_t max_frame_count,
+		float fitness_scale,
+		debug_span<types::fitness_t> fitness,
+		bool shared_inputs,
+		bool threshold_decisions,
+		const trainer* worker_placement,
+		const EvaluateSegment& evaluate_segment
+	);
+
+	flappy_birds::game_logic::config_t m_config;
+	std::uint32_t m_bird_count;
+	connectivity_t m_connectivity;
+	flappy_birds::game_logic::physics_engine_t m_physics_engine;
+	flappy_birds::game_logic::state_t m_state;
+	debug_vector<bool> m_flaps;
+	debug_vector<inference::types::value_t> m_inputs;
+	std::array<inference::types::value_t, 1> m_shared_inputs{};
+	debug_vector<inference::types::value_t> m_outputs;
+	// Feed forward networks only write one flap bit per bird.
+	debug_vector<std::uint64_t> m_flap_decisions;
+	inference::types::recurrent_state_t m_recurrent_state;
+};
+
+} // namespace neat::bench
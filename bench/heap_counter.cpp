@@ -0,0 +1,53 @@
+#include "heap_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace neat::bench {
+
+static std::atomic<std::uint64_t> allocation_count{};
+
+std::uint64_t heap_allocation_count() {
+	return allocation_count.load(std::memory_order_relaxed);
+}
+
+} // namespace neat::bench
+
+// The array and nothrow forms call these by default, so they are counted as well.
+void* operator new(const std::size_t size) {
+	neat::bench::allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (auto* const data = std::malloc(size == 0 ? 1 : size)) {
+		return data;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+	neat::bench::allocation_count.fetch_add(1, std::memory_order_relaxed);
+	const auto alignment_size = static_cast<std::size_t>(alignment);
+	// aligned_alloc only accepts multiples of the alignment.
+	const auto aligned_size = (std::max(size, std::size_t{ 1 }) + alignment_size - 1) / alignment_size * alignment_size;
+	if (auto* const data = std::aligned_alloc(alignment_size, aligned_size)) {
+		return data;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* const data) noexcept {
+	std::free(data);
+}
+
+void operator delete(void* const data, std::size_t) noexcept {
+	std::free(data);
+}
+
+void operator delete(void* const data, std::align_val_t) noexcept {
+	std::free(data);
+}
+
+void operator delete(void* const data, std::size_t, std::align_val_t) noexcept {
+	std::free(data);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace neat::bench {
+
+// Heap allocations of all threads since program start, counted by the replaced global operator new.
+// Includes allocations of the standard library, like the state of every started std::thread.
+[[nodiscard]] std::uint64_t heap_allocation_count();
+
+} // namespace neat::bench
@@ -0,0 +1,724 @@
+#include "benchmark.hpp"
+#include "generation_bench.hpp"
+#include "headless_flappy_birds.hpp"
+#include "neat/fitness_accumulator.hpp"
+#include "neat/helpers/connection_lookup.hpp"
+#include "neat/helpers/connection_sampler.hpp"
+#include "neat/helpers/species_sorter.hpp"
+#include "neat/helpers/topological_order.hpp"
+#include "neat/helpers/weight_mutation.hpp"
+#include "neat/inference.hpp"
+#include "neat/layered_inference.hpp"
+#include "neat/network_group_order.hpp"
+#include "neat/shared_input_inference.hpp"
+#include "neat/shared_topology_inference.hpp"
+#include "neat/trainer.hpp"
+#include "synthetic_population.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace neat::bench {
+
+// Exposes the internal trainer stages, so they can be measured in isolation.
+class trainer_bench : public trainer {
+public:
+	using trainer::trainer;
+
+	using trainer::compact_crossovers;
+	using trainer::create_crossovers;
+	using trainer::crossover_staging_t;
+	using trainer::update_inference_network_section;
+};
+
+class species_sorter_bench : public species_sorter {
+public:
+	using species_sorter::network_difference;
+};
+
+enum class bench_mode_t : std::uint8_t { micro, generations };
+
+struct bench_config_t {
+	bench_mode_t mode{ bench_mode_t::micro };
+	benchmark_config_t benchmark_config;
+	generation_bench_config_t generation_config;
+	synthetic_population_config_t population_config;
+	std::uint32_t bird_count{ 10'000 };
+	hugepage_policy_t hugepage_policy{ hugepage_policy_t::transparent };
+};
+
+static void print_usage(std::ostream& out) {
+	out << "Usage: neat-bench [options]\n"
+		   "  --mode=micro|generations  run the microbenchmarks or the end-to-end generation sweep\n"
+		   "\n"
+		   "Microbenchmark options:\n"
+		   "  --networks=N        number of networks in the synthetic population\n"
+		   "  --hidden=N          hidden nodes per network\n"
+		   "  --connections=N     connections per network\n"
+		   "  --inputs=N          input nodes per network\n"
+		   "  --outputs=N         output nodes per network\n"
+		   "  --disabled-rate=F   portion of disabled connections\n"
+		   "  --topologies=N      distinct topologies, the other networks only differ in weights (0 = all distinct)\n"
+		   "  --birds=N           birds simulated by the physics benchmark\n"
+		   "  --seed=N            seed of the synthetic population\n"
+		   "  --min-time-ms=N     minimum measuring time per benchmark\n"
+		   "  --filter=NAME       only run benchmarks whose name contains NAME\n"
+		   "\n"
+		   "Generation sweep options:\n"
+		   "  --generations=N     generations per population size and thread count\n"
+		   "  --populations=N,... population sizes to sweep\n"
+		   "  --threads=N,...     thread counts to sweep, defaults to powers of two up to the hardware concurrency\n"
+		   "  --max-frames=N      frame limit per game\n"
+		   "  --execution=phased|species|steady_state  reproduce step by step or species by species, or replace\n"
+		   "                      single networks while several threads report fitness\n"
+		   "  --replacements=N    replaced networks per population size and thread count in the steady state mode\n"
+		   "  --network-order=none|connections|shape  play with the compiled networks reordered by size or shape\n"
+		   "  --shared-inputs=0|1 play feed forward networks with the pipe distance shared and the bias folded in\n"
+		   "  --connectivity=feed_forward|recurrent  forbid or allow loops, recurrent birds remember earlier frames\n"
+		   "  --numa=none|partitioned     split the population between the NUMA nodes\n"
+		   "  --fake-numa-nodes=N pretend the machine has N NUMA nodes, implies --numa=partitioned\n"
+		   "  --affinity=floating|pinned  let workers float or pin every worker to one CPU\n"
+		   "  --avoid-smt=0|1     only run workers on the first logical CPU of every core\n"
+		   "  --reserved-cores=N  cores kept free of workers, e.g. for the game simulation\n"
+		   "  --seed=N            seed of the game\n"
+		   "\n"
+		   "  --hugepages=none|transparent|explicit  back large buffers with regular, transparent or reserved\n"
+		   "                      2 MB pages (default transparent), unavailable hugepages fall back to smaller pages\n"
+		   "  --format=json|csv   output format (json prints one object per line)\n";
+}
+
+template<typename T>
+static bool parse_number(const std::string_view text, T& value) {
+	if constexpr (std::is_floating_point_v<T>) {
+		// std::from_chars for floating point is not available everywhere yet.
+		try {
+			value = static_cast<T>(std::stod(std::string(text)));
+			return true;
+		} catch (...) {
+			return false;
+		}
+	} else {
+		const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+		return error == std::errc{} and end == text.data() + text.size();
+	}
+}
+
+static bool parse_number_list(std::string_view text, debug_vector<std::uint32_t>& values) {
+	values.clear();
+	while (not text.empty()) {
+		const auto separator = text.find(',');
+		auto& value = values.emplace_back();
+		if (not parse_number(text.substr(0, separator), value) or value == 0) {
+			return false;
+		}
+		text = separator == std::string_view::npos ? std::string_view{} : text.substr(separator + 1);
+	}
+	return not values.empty();
+}
+
+static bool parse_arguments(const int argc, char* argv[], bench_config_t& config) {
+	auto& population = config.population_config;
+	auto& interface = population.network_interface_config;
+	auto& benchmark = config.benchmark_config;
+
+	for (int i{ 1 }; i != argc; ++i) {
+		const auto argument = std::string_view(argv[i]);
+		const auto separator = argument.find('=');
+		const auto key = argument.substr(0, separator);
+		const auto value = separator == std::string_view::npos ? std::string_view{} : argument.substr(separator + 1);
+
+		auto min_time_ms = std::int64_t{};
+		auto valid = true;
+
+		if (key == "--help") {
+			return false;
+		} else if (key == "--mode" and (value == "micro" or value == "generations")) {
+			config.mode = value == "micro" ? bench_mode_t::micro : bench_mode_t::generations;
+		} else if (key == "--generations") {
+			valid = parse_number(value, config.generation_config.generation_count);
+		} else if (key == "--populations") {
+			valid = parse_number_list(value, config.generation_config.population_sizes);
+		} else if (key == "--threads") {
+			valid = parse_number_list(value, config.generation_config.thread_counts);
+		} else if (key == "--max-frames") {
+			valid = parse_number(value, config.generation_config.max_frame_count);
+		} else if (key == "--connectivity" and (value == "feed_forward" or value == "recurrent")) {
+			config.generation_config.connectivity = value == "feed_forward" ? connectivity_t::feed_forward
+			                                                                : connectivity_t::recurrent;
+		} else if (key == "--network-order" and (value == "none" or value == "connections" or value == "shape")) {
+			if (value == "none") {
+				config.generation_config.network_order.reset();
+			} else {
+				config.generation_config.network_order = value == "connections"
+					? inference::network_order_t::connection_count
+					: inference::network_order_t::shape;
+			}
+		} else if (key == "--shared-inputs" and (value == "0" or value == "1")) {
+			config.generation_config.shared_inputs = value == "1";
+		} else if (key == "--execution" and (value == "phased" or value == "species" or value == "steady_state")) {
+			config.generation_config.steady_state = value == "steady_state";
+			if (value != "steady_state") {
+				config.generation_config.execution_config.mode = value == "phased"
+					? execution_mode_t::phased
+					: execution_mode_t::species_parallel;
+			}
+		} else if (key == "--replacements") {
+			valid = parse_number(value, config.generation_config.replacement_count);
+		} else if (key == "--numa" and (value == "none" or value == "partitioned")) {
+			config.generation_config.execution_config.numa_policy = value == "none" ? numa_policy_t::none
+			                                                                        : numa_policy_t::partitioned;
+		} else if (key == "--fake-numa-nodes") {
+			valid = parse_number(value, config.generation_config.execution_config.fake_numa_node_count);
+			config.generation_config.execution_config.numa_policy = numa_policy_t::partitioned;
+		} else if (key == "--affinity" and (value == "floating" or value == "pinned")) {
+			config.generation_config.execution_config.affinity.policy = value == "floating"
+				? affinity_policy_t::floating
+				: affinity_policy_t::pinned;
+		} else if (key == "--avoid-smt" and (value == "0" or value == "1")) {
+			config.generation_config.execution_config.affinity.avoid_smt_siblings = value == "1";
+		} else if (key == "--reserved-cores") {
+			valid = parse_number(value, config.generation_config.execution_config.affinity.reserved_core_count);
+		} else if (key == "--networks") {
+			valid = parse_number(value, population.network_count);
+		} else if (key == "--hidden") {
+			valid = parse_number(value, population.hidden_node_count);
+		} else if (key == "--connections") {
+			valid = parse_number(value, population.connection_count);
+		} else if (key == "--inputs") {
+			valid = parse_number(value, interface.input_count);
+		} else if (key == "--outputs") {
+			valid = parse_number(value, interface.output_count);
+		} else if (key == "--disabled-rate") {
+			valid = parse_number(value, population.disabled_rate);
+		} else if (key == "--topologies") {
+			valid = parse_number(value, population.topology_count);
+		} else if (key == "--birds") {
+			valid = parse_number(value, config.bird_count);
+		} else if (key == "--seed") {
+			valid = parse_number(value, population.seed);
+			config.generation_config.seed = population.seed;
+		} else if (key == "--min-time-ms") {
+			valid = parse_number(value, min_time_ms);
+			benchmark.min_time = std::chrono::milliseconds(min_time_ms);
+		} else if (key == "--filter") {
+			benchmark.filter = value;
+		} else if (key == "--hugepages" and (value == "none" or value == "transparent" or value == "explicit")) {
+			config.hugepage_policy = value == "none" ? hugepage_policy_t::none
+				: value == "transparent"             ? hugepage_policy_t::transparent
+													 : hugepage_policy_t::explicit_pages;
+		} else if (key == "--format" and (value == "json" or value == "csv")) {
+			benchmark.format = value == "json" ? output_format_t::json : output_format_t::csv;
+			config.generation_config.format = benchmark.format;
+		} else {
+			valid = false;
+		}
+
+		if (not valid) {
+			std::cerr << "Invalid argument '" << argument << "'\n";
+			return false;
+		}
+	}
+
+	if (population.network_count < 2 or interface.input_count == 0 or interface.output_count == 0) {
+		std::cerr << "At least two networks, one input and one output are needed.\n";
+		return false;
+	}
+
+	return true;
+}
+
+static std::string population_parameters(const synthetic_population_config_t& config) {
+	return "networks=" + std::to_string(config.network_count) +
+		" inputs=" + std::to_string(config.network_interface_config.input_count) +
+		" outputs=" + std::to_string(config.network_interface_config.output_count) +
+		" hidden=" + std::to_string(config.hidden_node_count) +
+		" connections=" + std::to_string(config.connection_count) +
+		" topologies=" + std::to_string(config.topology_count);
+}
+
+static void resize_network_group(
+	const network_interface_config_t& interface_config,
+	const types::population_t& population,
+	inference::types::network_group_t& network_group
+) {
+	auto node_count = 2 * population.networks.size() * interface_config.output_count;
+	for (const auto& network : population.networks) {
+		node_count += network.hidden_node_count;
+	}
+
+	network_group.networks.resize(population.networks.size());
+	network_group.incoming_connection_counts_and_node_lookups.resize(node_count);
+	network_group.connections.resize(population.connections.size());
+}
+
+static void compile_network_group(
+	trainer_bench& trainer,
+	monotonic_arena& arena,
+	const types::population_t& population,
+	inference::types::network_group_t& network_group
+) {
+	auto network_range = types::network_range_t::from_range(population.networks);
+	auto node_range = types::conn_range_t::from_range(network_group.incoming_connection_counts_and_node_lookups);
+	auto conn_range = types::conn_range_t::from_range(network_group.connections);
+	trainer.update_inference_network_section(
+		arena,
+		population,
+		network_group,
+		network_range,
+		node_range,
+		conn_range
+	);
+}
+
+static void run_inference_benchmarks(
+	benchmark_runner& runner,
+	trainer_bench& trainer,
+	const bench_config_t& config,
+	const types::population_t& population
+) {
+	const auto& interface_config = config.population_config.network_interface_config;
+	const auto parameters = population_parameters(config.population_config);
+	const auto network_count = static_cast<std::uint64_t>(population.networks.size());
+
+	inference::types::network_group_t network_group;
+	resize_network_group(interface_config, population, network_group);
+
+	// The trainer resets its arena every generation.
+	monotonic_arena arena;
+	runner.run("update_inference_network_section", parameters, network_count, [&]() { arena.reset(); }, [&]() {
+		compile_network_group(trainer, arena, population, network_group);
+	});
+
+	compile_network_group(trainer, arena, population, network_group);
+
+	const auto view = inference::types::network_group_view_t(network_group);
+
+	debug_vector<inference::types::value_t> inputs(population.networks.size() * interface_config.input_count);
+	debug_vector<inference::types::value_t> outputs(population.networks.size() * interface_config.output_count);
+
+	auto rng = std::mt19937_64{ config.population_config.seed };
+	auto input_distrib = std::uniform_real_distribution<inference::types::value_t>(-1.0f, 1.0f);
+	std::generate(inputs.begin(), inputs.end(), [&]() { return input_distrib(rng); });
+
+	runner.run("evaluate_network_range", parameters, network_count, []() {}, [&]() {
+		inference::evaluate_network_range(view, inputs, outputs, types::network_range_t::from_range(view.networks));
+	});
+
+	// Every network keeps its input row, so the reordered group reads the same inputs in a different order.
+	for (const auto order : { inference::network_order_t::connection_count, inference::network_order_t::shape }) {
+		const auto order_parameters = parameters +
+			(order == inference::network_order_t::connection_count ? " order=connections" : " order=shape");
+
+		inference::types::network_group_t reordered_network_group;
+		debug_vector<types::network_index_t> original_network_indices;
+
+		runner.run("reorder_network_group", order_parameters, network_count, []() {}, [&]() {
+			inference::reorder_network_group(
+				view, interface_config, order, reordered_network_group, original_network_indices
+			);
+		});
+
+		inference::reorder_network_group(
+			view, interface_config, order, reordered_network_group, original_network_indices
+		);
+
+		runner.run("evaluate_reordered_network_range", order_parameters, network_count, []() {}, [&]() {
+			inference::evaluate_network_range(
+				reordered_network_group,
+				inputs,
+				outputs,
+				types::network_range_t::from_range(reordered_network_group.networks)
+			);
+		});
+	}
+
+	debug_vector<std::uint64_t> decisions((outputs.size() + 63) / 64);
+
+	runner.run("evaluate_network_range_threshold", parameters, network_count, []() {}, [&]() {
+		inference::evaluate_network_range_threshold(
+			view,
+			inputs,
+			decisions,
+			0.5f,
+			interface_config.output_count,
+			types::network_range_t::from_range(view.networks)
+		);
+	});
+
+	debug_vector<inference::types::output_index_t> output_indices(population.networks.size());
+
+	runner.run("evaluate_network_range_argmax", parameters, network_count, []() {}, [&]() {
+		inference::evaluate_network_range_argmax(
+			view,
+			inputs,
+			output_indices,
+			interface_config.output_count,
+			types::network_range_t::from_range(view.networks)
+		);
+	});
+
+	// Like the game inputs: the first input is the same for all networks and the last one is a bias.
+	if (interface_config.input_count >= 2) {
+		auto input_layout = inference::input_layout_t{
+			.sources = debug_vector<inference::input_source_t>(
+				interface_config.input_count,
+				inference::input_source_t::per_network
+			),
+			.constant_values = debug_vector<inference::types::value_t>(interface_config.input_count, 1.0f)
+		};
+		input_layout.sources.front() = inference::input_source_t::shared;
+		input_layout.sources.back() = inference::input_source_t::constant;
+
+		inference::types::shared_input_network_group_t shared_input_network_group;
+
+		runner.run("compile_shared_input_network_group", parameters, network_count, []() {}, [&]() {
+			inference::compile_shared_input_network_group(
+				view, interface_config, input_layout, shared_input_network_group
+			);
+		});
+
+		inference::compile_shared_input_network_group(view, interface_config, input_layout, shared_input_network_group);
+
+		const auto per_network_input_count = shared_input_network_group.per_network_input_count;
+		const auto shared_inputs = debug_span<const inference::types::value_t>(inputs.data(), 1);
+		const auto network_inputs = debug_span<const inference::types::value_t>(
+			inputs.data(), population.networks.size() * per_network_input_count
+		);
+
+		runner.run("evaluate_shared_input_network_range", parameters, network_count, []() {}, [&]() {
+			inference::evaluate_network_range(
+				shared_input_network_group,
+				shared_inputs,
+				network_inputs,
+				outputs,
+				types::network_range_t::from_range(view.networks)
+			);
+		});
+	}
+
+	// The feed forward networks evaluated as if they were recurrent, which costs the same per step.
+	inference::types::recurrent_state_t recurrent_state;
+	inference::reset_recurrent_state(view, recurrent_state);
+
+	runner.run("evaluate_recurrent_network_range", parameters, network_count, []() {}, [&]() {
+		inference::evaluate_network_range(
+			view, recurrent_state, inputs, outputs, types::network_range_t::from_range(view.networks)
+		);
+	});
+
+	// Everything dense, the default threshold and everything sparse.
+	inference::types::layered_network_group_t layered_network_group;
+	for (const auto min_dense_density : { 0.0f, inference::layer_config_t{}.min_dense_density, 2.0f }) {
+		const auto layer_config = inference::layer_config_t{ .min_dense_density = min_dense_density };
+		const auto layer_parameters = parameters + " min_dense_density=" + std::to_string(min_dense_density);
+
+		runner.run("compile_layered_network_group", layer_parameters, network_count, []() {}, [&]() {
+			inference::compile_layered_network_group(view, interface_config, layer_config, layered_network_group);
+		});
+
+		inference::compile_layered_network_group(view, interface_config, layer_config, layered_network_group);
+
+		runner.run("evaluate_layered_network_range", layer_parameters, network_count, []() {}, [&]() {
+			inference::evaluate_network_range(
+				layered_network_group,
+				inputs,
+				outputs,
+				types::network_range_t::from_range(layered_network_group.networks)
+			);
+		});
+	}
+
+	inference::types::shared_topology_network_group_t shared_topology_network_group;
+
+	runner.run("compile_shared_topology_network_group", parameters, network_count, []() {}, [&]() {
+		inference::compile_shared_topology_network_group(view, interface_config, shared_topology_network_group);
+	});
+
+	inference::compile_shared_topology_network_group(view, interface_config, shared_topology_network_group);
+
+	runner.run("evaluate_shared_topology_network_range", parameters, network_count, []() {}, [&]() {
+		inference::evaluate_network_range(
+			shared_topology_network_group, inputs, outputs, types::network_range_t::from_range(view.networks)
+		);
+	});
+}
+
+static void run_trainer_benchmarks(
+	benchmark_runner& runner,
+	trainer_bench& trainer,
+	const bench_config_t& config,
+	const types::population_t& population
+) {
+	const auto parameters = population_parameters(config.population_config);
+	const auto network_count = static_cast<types::network_index_t>(population.networks.size());
+
+	const auto fitness = create_synthetic_fitness(config.population_config, network_count);
+
+	// Every network is crossed with a pseudo random partner.
+	debug_vector<types::parents_t> parents(network_count);
+	for (types::network_index_t i{}; i != network_count; ++i) {
+		parents[i] = { i, static_cast<types::network_index_t>((i * 7 + 1) % network_count) };
+	}
+
+	debug_vector<types::network_t> offspring_networks(network_count);
+	trainer_bench::crossover_staging_t staging;
+
+	const auto clear_staging = [&]() {
+		staging.connections.clear();
+		staging.connection_weights.clear();
+		staging.connection_infos.clear();
+	};
+
+	runner.run("create_crossovers", parameters, network_count, clear_staging, [&]() {
+		trainer.create_crossovers(
+			0,
+			population.networks,
+			population.connections,
+			population.connection_weights,
+			population.connection_infos,
+			fitness,
+			parents,
+			offspring_networks,
+			staging,
+			0,
+			types::network_range_t::from_index_count(0, network_count)
+		);
+	});
+
+	types::population_t offspring;
+	offspring.connections.resize(staging.connections.size());
+	offspring.connection_weights.resize(staging.connections.size());
+	offspring.connection_infos.resize(staging.connections.size());
+
+	// The staged ranges are restored, as compacting shifts them by the offset.
+	const auto staged_networks = offspring_networks;
+
+	runner.run(
+		"compact_crossovers",
+		parameters,
+		network_count,
+		[&]() { std::copy(staged_networks.begin(), staged_networks.end(), offspring_networks.begin()); },
+		[&]() {
+			trainer_bench::compact_crossovers(
+				staging,
+				0,
+				offspring_networks,
+				offspring.connections,
+				offspring.connection_weights,
+				offspring.connection_infos,
+				types::network_range_t::from_index_count(0, network_count)
+			);
+		}
+	);
+}
+
+static void run_helper_benchmarks(
+	benchmark_runner& runner, const bench_config_t& config, const types::population_t& population
+) {
+	const auto parameters = population_parameters(config.population_config);
+	const auto network_count = static_cast<types::network_index_t>(population.networks.size());
+
+	const auto difference_config = difference_config_t{};
+
+	runner.run("network_difference", parameters, network_count, []() {}, [&]() {
+		auto difference_sum = types::network_difference_t{};
+		for (types::network_index_t i{}; i != network_count; ++i) {
+			difference_sum += species_sorter_bench::network_difference(
+				difference_config,
+				population.connection_weights,
+				population.connection_infos,
+				population.networks[i],
+				population.networks[(i + 1) % network_count]
+			);
+		}
+		do_not_optimize(difference_sum);
+	});
+
+	const auto& interface_config = config.population_config.network_interface_config;
+	const auto node_count = interface_config.input_count + interface_config.output_count +
+		config.population_config.hidden_node_count;
+
+	// Queries a random node pair for every network, which includes both looping and non looping connections.
+	auto node_distrib = std::uniform_int_distribution<types::node_index_t>(0, node_count - 1);
+	debug_vector<types::connection_t> loop_queries(network_count);
+	auto rng = std::mt19937_64{ config.population_config.seed };
+	std::generate(loop_queries.begin(), loop_queries.end(), [&]() {
+		return types::connection_t{ .from = node_distrib(rng), .to = node_distrib(rng) };
+	});
+
+	debug_vector<topological_order> orders(network_count);
+
+	runner.run("topological_order::assign", parameters, network_count, []() {}, [&]() {
+		for (types::network_index_t i{}; i != network_count; ++i) {
+			orders[i].assign(node_count, population.networks[i].connections.span(population.connections));
+		}
+	});
+
+	runner.run("topological_order::would_create_loop", parameters, network_count, []() {}, [&]() {
+		auto loop_count = std::size_t{};
+		for (types::network_index_t i{}; i != network_count; ++i) {
+			const auto& [from, to] = loop_queries[i];
+			loop_count += orders[i].would_create_loop(from, to);
+		}
+		do_not_optimize(loop_count);
+	});
+
+	auto& order = orders.front();
+
+	// Rebuilds every network connection by connection, like crossovers do.
+	runner.run("topological_order::try_add_connection", parameters, population.connections.size(), []() {}, [&]() {
+		auto added_count = std::size_t{};
+		for (const auto& network : population.networks) {
+			order.reset(node_count);
+			for (const auto& [from, to] : network.connections.span(population.connections)) {
+				added_count += order.try_add_connection(from, to);
+			}
+		}
+		do_not_optimize(added_count);
+	});
+
+	auto weights = population.connection_weights;
+
+	for (const auto perturbation : { weight_perturbation_t::uniform, weight_perturbation_t::gaussian }) {
+		auto distribution_config = weight_distribution_config_t{};
+		distribution_config.perturbation = perturbation;
+
+		const auto stream = weight_mutation_stream_t{ .key = philox_rng::make_key(config.population_config.seed),
+			                                          .generation = 0,
+			                                          .purpose = 0 };
+
+		runner.run(
+			perturbation == weight_perturbation_t::uniform ? "mutate_weights(uniform)" : "mutate_weights(gaussian)",
+			parameters,
+			weights.size(),
+			[]() {},
+			[&]() { mutate_weights(distribution_config, 0.9f, stream, 0, weights); }
+		);
+	}
+
+	connection_sampler sampler;
+
+	// Collects and draws one new connection per network, like the add connection mutation does.
+	runner.run("connection_sampler", parameters, network_count, []() {}, [&]() {
+		auto candidate_sum = types::node_index_t{};
+		for (const auto& network : population.networks) {
+			sampler.assign(
+				config.population_config.network_interface_config,
+				network.hidden_node_count,
+				network.connections.span(population.connections)
+			);
+			if (sampler.candidate_count() != 0) {
+				candidate_sum += sampler.candidate(candidate_sum % sampler.candidate_count()).to;
+			}
+		}
+		do_not_optimize(candidate_sum);
+	});
+
+	connection_lookup lookup;
+	debug_vector<types::connection_info_t> connection_infos(population.connections.size());
+
+	runner.run(
+		"connection_lookup::update_connection_info",
+		parameters,
+		population.connections.size(),
+		[&]() { lookup.clear(); },
+		[&]() {
+			for (types::conn_index_t i{}; i != population.connections.size(); ++i) {
+				const auto& [from, to] = population.connections[i];
+				lookup.update_connection_info(connection_infos, i, from, to);
+			}
+		}
+	);
+
+	// Every network has a fixed skill plus noise per episode, racing only keeps evaluating the promising ones.
+	static constexpr auto racing_episode_count = 10u;
+
+	auto skill_distrib = std::normal_distribution<types::fitness_t>(0.0f, 1.0f);
+	debug_vector<types::fitness_t> episode_fitness(racing_episode_count * network_count);
+	std::generate(episode_fitness.begin(), episode_fitness.end(), [&]() { return skill_distrib(rng); });
+
+	for (const auto policy : { racing_policy_t::none, racing_policy_t::confidence_bounds }) {
+		auto accumulator = fitness_accumulator(racing_config_t{ .policy = policy });
+
+		runner.run(
+			policy == racing_policy_t::none ? "fitness_accumulator(none)" : "fitness_accumulator(confidence_bounds)",
+			parameters,
+			racing_episode_count * network_count,
+			[]() {},
+			[&]() {
+				accumulator.reset(network_count);
+				for (std::uint32_t episode{}; episode != racing_episode_count; ++episode) {
+					for (const auto& network_index : accumulator.active_networks()) {
+						const auto skill = static_cast<types::fitness_t>(network_index % 16);
+						const auto episode_index = episode * network_count + network_index;
+						accumulator.report(network_index, skill + episode_fitness[episode_index]);
+					}
+					accumulator.update_racing();
+				}
+				do_not_optimize(accumulator.episode_count());
+			}
+		);
+	}
+}
+
+static void run_physics_benchmarks(benchmark_runner& runner, const bench_config_t& config) {
+	const auto bird_count = config.bird_count;
+	const auto parameters = "birds=" + std::to_string(bird_count);
+
+	auto game = headless_flappy_birds(flappy_birds::game_logic::config_t{}, bird_count, config.population_config.seed);
+
+	auto rng = std::mt19937_64{ config.population_config.seed };
+	auto flap_distrib = std::bernoulli_distribution(0.1);
+
+	const auto reset_game = [&]() {
+		game.reset();
+		auto& flaps = game.flaps();
+		std::generate(flaps.begin(), flaps.end(), [&]() { return flap_distrib(rng); });
+	};
+
+	static constexpr auto dt = 1.0f / 60.0f;
+
+	runner.run("physics_engine_t::update", parameters, bird_count, reset_game, [&]() { game.update(dt); });
+}
+
+} // namespace neat::bench
+
+int main(int argc, char* argv[]) {
+	using namespace neat::bench;
+
+	auto config = bench_config_t{};
+	if (not parse_arguments(argc, argv, config)) {
+		print_usage(std::cerr);
+		return EXIT_FAILURE;
+	}
+
+	set_hugepage_policy(config.hugepage_policy);
+
+	if (config.mode == bench_mode_t::generations) {
+		run_generation_benchmarks(config.generation_config, std::cout);
+		return EXIT_SUCCESS;
+	}
+
+	const auto population = create_synthetic_population(config.population_config);
+
+	trainer_bench trainer(
+		neat::evolution_config_t{},
+		config.population_config.network_interface_config,
+		1,
+		1,
+		config.population_config.seed
+	);
+	benchmark_runner runner(config.benchmark_config, std::cout);
+
+	run_inference_benchmarks(runner, trainer, config, population);
+	run_trainer_benchmarks(runner, trainer, config, population);
+	run_helper_benchmarks(runner, config, population);
+	run_physics_benchmarks(runner, config);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+#include "synthetic_population.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace neat::bench {
+
+types::population_t create_synthetic_population(const synthetic_population_config_t& config) {
+	const auto& [input_count, output_count] = config.network_interface_config;
+	const auto node_count = input_count + config.hidden_node_count + output_count;
+
+	// Nodes are drawn in topological order (inputs, hidden, outputs) and connections only point forward,
+	// which guarantees loop free networks.
+	const auto node_index_at = [&](const types::node_index_t& position) -> types::node_index_t {
+		if (position < input_count) {
+			return position;
+		} else if (position < input_count + config.hidden_node_count) {
+			return input_count + output_count + (position - input_count);
+		} else {
+			return input_count + (position - input_count - config.hidden_node_count);
+		}
+	};
+
+	debug_vector<types::connection_t> candidate_connections;
+	for (types::node_index_t from{}; from != input_count + config.hidden_node_count; ++from) {
+		for (auto to = std::max(from + 1, input_count); to != node_count; ++to) {
+			candidate_connections.push_back({ .from = node_index_at(from), .to = node_index_at(to) });
+		}
+	}
+
+	const auto connection_count = std::min(config.connection_count, candidate_connections.size());
+
+	auto rng = std::mt19937_64{ config.seed };
+	auto weight_distrib = std::uniform_real_distribution<types::connection_weight_t>(-1.0f, 1.0f);
+	auto chance_distrib = std::uniform_real_distribution<float>(0.0f, 1.0f);
+
+	types::population_t population;
+
+	population.species.push_back({ .networks = types::network_range_t::from_index_count(0, config.network_count) });
+
+	population.networks.resize(config.network_count);
+	population.connections.resize(config.network_count * connection_count);
+	population.connection_weights.resize(population.connections.size());
+	population.connection_infos.resize(population.connections.size());
+
+	debug_vector<types::conn_index_t> candidate_indices(candidate_connections.size());
+
+	for (types::network_index_t i{}; i != config.network_count; ++i) {
+		auto& network = population.networks[i];
+		network.hidden_node_count = config.hidden_node_count;
+		network.connections = types::conn_range_t::from_index_count(i * connection_count, connection_count);
+
+		if (config.topology_count != 0 and i >= config.topology_count) {
+			// Like offspring that only mutated the weights of their ancestor.
+			const auto& ancestor = population.networks[i % config.topology_count];
+			std::copy_n(
+				population.connections.begin() + ancestor.connections.begin(),
+				connection_count,
+				population.connections.begin() + network.connections.begin()
+			);
+			std::copy_n(
+				population.connection_infos.begin() + ancestor.connections.begin(),
+				connection_count,
+				population.connection_infos.begin() + network.connections.begin()
+			);
+			std::generate_n(
+				population.connection_weights.begin() + network.connections.begin(),
+				connection_count,
+				[&]() { return weight_distrib(rng); }
+			);
+			continue;
+		}
+
+		// Innovation numbers are the candidate indices, so sorting the sample keeps the connections sorted by
+		// innovation number like the trainer expects.
+		std::iota(candidate_indices.begin(), candidate_indices.end(), types::conn_index_t{});
+		std::shuffle(candidate_indices.begin(), candidate_indices.end(), rng);
+		std::sort(candidate_indices.begin(), candidate_indices.begin() + connection_count);
+
+		for (types::conn_index_t j{}; j != connection_count; ++j) {
+			const auto conn_index = network.connections.begin() + j;
+			const auto candidate_index = candidate_indices[j];
+
+			population.connections[conn_index] = candidate_connections[candidate_index];
+			population.connection_weights[conn_index] = weight_distrib(rng);
+			population.connection_infos[conn_index] = { .enabled = chance_distrib(rng) >= config.disabled_rate,
+				                                        .innovation_number = candidate_index };
+		}
+	}
+
+	return population;
+}
+
+debug_vector<types::fitness_t> create_synthetic_fitness(
+	const synthetic_population_config_t& config, const types::network_index_t network_count
+) {
+	auto rng = std::mt19937_64{ config.seed + 1 };
+	auto fitness_distrib = std::uniform_real_distribution<types::fitness_t>(0.0f, 1.0f);
+
+	debug_vector<types::fitness_t> fitness(network_count);
+	std::generate(fitness.begin(), fitness.end(), [&]() { return fitness_distrib(rng); });
+
+	return fitness;
+}
+
+} // namespace neat::bench
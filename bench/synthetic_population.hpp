@@ -0,0 +1,32 @@
+#pragma once
+
+#include "neat/network_interface_config.hpp"
+#include "neat/types.hpp"
+
+#include <cinttypes>
+
+namespace neat::bench {
+
+struct synthetic_population_config_t {
+	network_interface_config_t network_interface_config{ .input_count = 4, .output_count = 1 };
+	types::network_index_t network_count{ 1'000 };
+	types::node_index_t hidden_node_count{ 8 };
+	types::conn_index_t connection_count{ 32 };
+	// Portion of connections that are disabled.
+	float disabled_rate{ 0.1f };
+	// Number of distinct topologies, later networks repeat them with new weights. Zero gives every network its own.
+	types::network_index_t topology_count{ 0 };
+	std::uint64_t seed{ 42 };
+};
+
+// Generates a single species population of loop free networks with the given shape.
+// All networks draw their connections from the same pool of node pairs, so innovation numbers match between networks
+// like they would after a few generations of evolution.
+types::population_t create_synthetic_population(const synthetic_population_config_t& config);
+
+// Generates fitness values in [0, 1] for every network.
+debug_vector<types::fitness_t> create_synthetic_fitness(
+	const synthetic_population_config_t& config, types::network_index_t network_count
+);
+
+} // namespace neat::bench
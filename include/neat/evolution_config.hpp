@@ -20,9 +20,22 @@ struct extinction_config_t {
 	float max_remove_score_portion{ 0.2 };
 };
 
+enum class weight_perturbation_t : std::uint8_t { uniform, gaussian };
+
 struct weight_distribution_config_t {
 	float conn_weight_min{ 0.0f }, conn_weight_max{ 1.0f };
+	weight_perturbation_t perturbation{ weight_perturbation_t::uniform };
+	// Used by uniform perturbations.
 	float conn_weight_offset_min{ -0.01f }, conn_weight_offset_max{ 0.01f };
+	// Used by gaussian perturbations.
+	float conn_weight_offset_stddev{ 0.01f };
+};
+
+struct steady_state_config_t {
+	// Portion of the population that has to be evaluated before the first network gets replaced.
+	float min_evaluated_portion{ 0.5f };
+	// A parent is the fittest of this many randomly drawn evaluated networks.
+	std::uint32_t tournament_size{ 3 };
 };
 
 struct difference_config_t {
@@ -32,12 +45,18 @@ struct difference_config_t {
 	float difference_avg_weight_weights{ 0.4f };
 };
 
+enum class connectivity_t : std::uint8_t { feed_forward, recurrent };
+
 struct evolution_config_t {
 	difference_config_t difference_config;
 	mutation_rate_config_t mutation_rate_config;
 	extinction_config_t extinction_config;
 	weight_distribution_config_t weight_distribution_config;
+	steady_state_config_t steady_state_config;
 	float fitness_epsilon{ 0.001f };
+	// Recurrent networks may contain loops, so mutations and crossovers skip all loop detection. Their nodes are
+	// compiled in node index order and have to be evaluated with a recurrent state.
+	connectivity_t connectivity{ connectivity_t::feed_forward };
 };
 
 } // namespace neat
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace neat {
+
+enum class execution_mode_t : std::uint8_t {
+	// Every reproduction step runs over the offspring of all species, before the next step starts.
+	phased,
+	// Every species reproduces all of its offspring as one work unit, the species are spread over the threads.
+	// The genomes of a species stay in cache while its offspring are created and there are fewer barriers.
+	species_parallel
+};
+
+enum class numa_policy_t : std::uint8_t {
+	// Memory ends up on the node of the thread that first touches it and workers run on any CPU.
+	none,
+	// The population and inference arrays are split evenly between the NUMA nodes in network order and every
+	// node's part is first touched by a thread on that node. Workers are pinned to the node that owns the networks
+	// they process, so their scratch buffers end up on that node as well.
+	partitioned
+};
+
+enum class affinity_policy_t : std::uint8_t {
+	// Workers may run on any of the worker CPUs, or any of the worker CPUs of their node if the numa policy
+	// is partitioned. Without restrictions of the worker CPUs they aren't pinned at all.
+	floating,
+	// Every worker is pinned to a single CPU, picked by the networks it processes, so it isn't migrated mid phase
+	// and neighbouring networks are processed on the same CPU in every phase.
+	pinned
+};
+
+struct affinity_config_t {
+	affinity_policy_t policy{ affinity_policy_t::floating };
+	// Only the first logical CPU of every core runs workers, so no two workers share the execution units of a core.
+	bool avoid_smt_siblings{ false };
+	// Cores left to other threads, for example the environment simulation. They are taken from the end of the last
+	// NUMA nodes and every node keeps at least one core.
+	std::uint32_t reserved_core_count{ 0 };
+};
+
+struct execution_config_t {
+	execution_mode_t mode{ execution_mode_t::phased };
+	numa_policy_t numa_policy{ numa_policy_t::none };
+	// Splits the usable CPUs into this many nodes instead of reading the topology of the machine,
+	// so the partitioning can be tested on a single node. Zero uses the real topology.
+	std::uint32_t fake_numa_node_count{ 0 };
+	affinity_config_t affinity{};
+};
+
+} // namespace neat
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <cinttypes>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat {
+
+enum class racing_policy_t : std::uint8_t { none, confidence_bounds };
+
+struct racing_config_t {
+	racing_policy_t policy{ racing_policy_t::none };
+	// Episodes a network is evaluated for before it can be terminated.
+	std::uint32_t min_episode_count{ 3 };
+	// A network is terminated once its upper confidence bound falls below the lower confidence bound
+	// of the network ranked at this portion of the population.
+	float elite_portion{ 0.2f };
+	// Half width of the confidence bounds in standard errors.
+	float confidence_width{ 2.0f };
+};
+
+// Collects the fitness of a population episode by episode, so evaluators can report results as soon as they finish.
+// The fitness of a network is the mean over its reported episodes.
+// With a racing policy, networks that are statistically unable to reach the elite are terminated early,
+// so the remaining episodes only need to be run for the active networks.
+class fitness_accumulator {
+public:
+	explicit fitness_accumulator(const racing_config_t& racing_config = {});
+
+	// Starts a new evaluation with all networks active and no episodes reported.
+	void reset(types::network_index_t network_count);
+
+	// Different networks may be reported concurrently, but every network only from one thread at a time.
+	void report(types::network_index_t network_index, types::fitness_t episode_fitness);
+
+	// Applies the racing policy and returns the number of networks still active.
+	// Must not run concurrently with report, typically it is called after every episode.
+	types::network_index_t update_racing();
+
+	[[nodiscard]] bool is_active(types::network_index_t network_index) const;
+
+	[[nodiscard]] debug_span<const types::network_index_t> active_networks() const;
+
+	// Can be passed to trainer::evolve directly.
+	[[nodiscard]] debug_span<const types::fitness_t> fitness() const;
+
+	// Total number of reported episodes over all networks.
+	[[nodiscard]] std::uint64_t episode_count() const;
+
+private:
+	racing_config_t m_racing_config;
+
+	// Running mean and sum of squared deviations (Welford), so the variance is available at any point.
+	debug_vector<types::fitness_t> m_fitness;
+	debug_vector<float> m_squared_deviations;
+	debug_vector<std::uint32_t> m_episode_counts;
+	debug_vector<bool> m_active;
+	debug_vector<types::network_index_t> m_active_networks;
+	debug_vector<float> m_lower_bounds;
+};
+
+} // namespace neat
@@ -6,7 +6,7 @@
 #include <span>
 #include "util/debug_span.hpp" // TODO remove
 #include "util/debug_vector.hpp" // TODO remove
-#include <atomic>
+#include "util/spin_lock.hpp"
 
 namespace neat {
 
@@ -29,11 +29,15 @@ public:
 		const types::node_index_t& to
 	);
 
+	[[nodiscard]] spin_lock_stats_t lock_stats() const;
+
+	void reset_lock_stats();
+
 private:
 	std::pair<std::size_t, bool> lookup_connection(const sorted_node_pair& conn);
 
-	std::atomic_flag lock = ATOMIC_FLAG_INIT;
-	types::innovation_number_t m_innovation_counter;
+	spin_lock m_lock;
+	types::innovation_number_t m_innovation_counter{};
 	debug_vector<sorted_node_pair> m_node_pairs;
 };
 
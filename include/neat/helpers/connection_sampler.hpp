@@ -0,0 +1,57 @@
+#pragma once
+
+#include "neat/helpers/topological_order.hpp"
+#include "neat/network_interface_config.hpp"
+#include "neat/types.hpp"
+
+#include <cinttypes>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat {
+
+// Enumerates all connections that could be added to a network, so a new connection can be sampled uniformly in one
+// draw instead of retrying random node pairs. A connection is a candidate if it starts at an input or hidden node,
+// ends at an output or hidden node, is not yet part of the network and does not close a loop, unless loops are allowed.
+// Connections from a node to itself are never candidates.
+// The candidates are kept as one bitset row of allowed destinations per source node.
+// All buffers are reused between networks, so one instance per thread is enough.
+class connection_sampler {
+public:
+	// Unless loops are allowed, the connections must not contain a loop.
+	void assign(
+		const network_interface_config_t& interface_config,
+		types::node_index_t hidden_node_count,
+		debug_span<const types::connection_t> connections,
+		bool allow_loops = false
+	);
+
+	[[nodiscard]] std::size_t candidate_count() const;
+
+	// Returns the candidate with the given index in [0, candidate_count()).
+	[[nodiscard]] types::connection_t candidate(std::size_t index) const;
+
+private:
+	using word_t = std::uint64_t;
+	static constexpr auto word_bit_count = types::node_index_t{ sizeof(word_t) * 8 };
+
+	[[nodiscard]] debug_span<word_t> row(debug_vector<word_t>& rows, types::node_index_t node) const;
+
+	[[nodiscard]] debug_span<const word_t> row(const debug_vector<word_t>& rows, types::node_index_t node) const;
+
+	types::node_index_t m_input_count{}, m_output_count{}, m_node_count{};
+	types::node_index_t m_words_per_row{};
+
+	topological_order m_order;
+	debug_vector<types::conn_index_t> m_rank_offsets;
+	debug_vector<types::connection_t> m_rank_sorted_connections;
+
+	// Row of every node that has the bits of its predecessors set, which are the nodes it must not connect to.
+	// Afterwards the rows are inverted and masked, so they contain the valid destinations instead.
+	debug_vector<word_t> m_rows;
+	// Number of candidates starting at the source nodes before and including the given one.
+	debug_vector<std::size_t> m_candidate_count_prefixes;
+	debug_vector<types::node_index_t> m_source_nodes;
+};
+
+} // namespace neat
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstddef>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat {
+
+// The CPUs of every NUMA node, so workers can run next to the memory they process.
+// Arrays are partitioned by splitting them evenly between the nodes in index order.
+// A default constructed topology has a single node without CPUs and never pins threads.
+class numa_topology {
+public:
+	// Reads the nodes from sysfs and keeps only the CPUs this process may run on.
+	// Falls back to a single node with all usable CPUs if the nodes can't be read.
+	[[nodiscard]] static numa_topology detect();
+
+	// Splits the usable CPUs evenly into the given number of nodes, so the partitioning can be tested
+	// on a single node machine. If there are fewer CPUs than nodes, the nodes share them.
+	[[nodiscard]] static numa_topology fake(std::uint32_t node_count);
+
+	// Removes the CPUs workers must not run on. With avoid_smt_siblings only the first logical CPU of every core
+	// is kept. The reserved cores are taken from the end of the last nodes and every node keeps at least one core.
+	void restrict_worker_cpus(bool avoid_smt_siblings, std::uint32_t reserved_core_count);
+
+	[[nodiscard]] std::uint32_t node_count() const;
+
+	[[nodiscard]] debug_span<const std::uint32_t> cpus(std::uint32_t node) const;
+
+	// Node owning the element at index of an array with the given size.
+	[[nodiscard]] std::uint32_t partition_node(std::size_t index, std::size_t size) const;
+
+	// Restricts the calling thread to the CPUs of the node. Returns false if the thread couldn't be pinned.
+	bool pin_current_thread(std::uint32_t node) const;
+
+	// Pins the calling thread to a single CPU of the node owning the element at index. The CPUs of every node
+	// are split evenly between the elements the node owns, so neighbouring elements share a CPU.
+	bool pin_current_thread(std::size_t index, std::size_t size) const;
+
+	// Logical CPU the calling thread runs on, or -1 if it can't be determined.
+	[[nodiscard]] static int current_cpu();
+
+	// Touches every node's partition of the memory from a thread pinned to that node, so the kernel places the pages
+	// on the owning node. Meant for fresh memory, that was never touched. Pages touched before are released first
+	// and read as zero afterwards, or stay where they are if the kernel can't release them. The partitions are split
+	// at multiples of page_size, so pages larger than the system page size aren't shared between nodes.
+	// Partial pages at the ends stay where they are.
+	void first_touch(void* data, std::size_t byte_count, std::size_t page_size) const;
+
+private:
+	struct node_t {
+		debug_vector<std::uint32_t> cpus;
+	};
+
+	static bool pin_current_thread_to(debug_span<const std::uint32_t> cpus);
+
+	debug_vector<node_t> m_nodes = debug_vector<node_t>(1);
+};
+
+} // namespace neat
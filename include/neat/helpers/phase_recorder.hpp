@@ -0,0 +1,65 @@
+#pragma once
+
+#include "neat/helpers/numa_topology.hpp"
+#include "neat/trainer_stats.hpp"
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <utility>
+
+namespace neat {
+
+class phase_recorder {
+public:
+	using clock_t = std::chrono::steady_clock;
+
+	void begin_generation();
+
+	void end_generation();
+
+	void record(trainer_phase_t phase, clock_t::time_point begin, clock_t::time_point end);
+
+	// Adds serial work of the calling thread to the wall time of trainer_phase_t::serial.
+	void record_serial(clock_t::time_point begin, clock_t::time_point end);
+
+	// Wraps a worker function, so its busy time and whether it was migrated is recorded for the given phase.
+	template<typename F>
+	[[nodiscard]] auto timed(trainer_phase_t phase, F&& worker);
+
+	// Called by workers after they pinned themselves, so being moved to the pinned CPU isn't counted as a migration.
+	static void worker_placed();
+
+	[[nodiscard]] generation_stats_t& stats();
+
+	[[nodiscard]] const generation_stats_t& stats() const;
+
+private:
+	void record_migration(trainer_phase_t phase);
+
+	// CPU the worker of the calling thread started on or was placed on.
+	static inline thread_local int s_worker_cpu{ -1 };
+
+	std::mutex m_mutex;
+	std::size_t m_generation_count{};
+	clock_t::time_point m_generation_begin;
+	std::array<std::pair<clock_t::time_point, clock_t::time_point>, trainer_phase_count> m_phase_bounds;
+	// Serial work is spread over the generation, so its bounds would include the parallel phases in between.
+	std::chrono::nanoseconds m_serial_time{};
+	generation_stats_t m_stats;
+};
+
+template<typename F>
+auto phase_recorder::timed(const trainer_phase_t phase, F&& worker) {
+	return [this, phase, worker = std::forward<F>(worker)]() mutable {
+		const auto begin = clock_t::now();
+		s_worker_cpu = numa_topology::current_cpu();
+		worker();
+		record(phase, begin, clock_t::now());
+		if (numa_topology::current_cpu() != s_worker_cpu) {
+			record_migration(phase);
+		}
+	};
+}
+
+} // namespace neat
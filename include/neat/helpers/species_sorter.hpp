@@ -3,34 +3,70 @@
 #include "neat/evolution_config.hpp"
 #include "neat/types.hpp"
 
-#include <atomic>
 #include <deque>
+#include <utility>
+#include "util/debug_vector.hpp" // TODO remove
+#include "util/spin_lock.hpp"
 
 namespace neat {
 
+// Sorts the networks into species, the same way regardless of how the networks are split between threads:
+// 1. find_candidates speciates every chunk of candidate_chunk_size networks on its own.
+// 2. pick_representatives keeps the candidates that match none of the representatives kept before, in network order.
+// 3. sort_into_buckets adds every network to the bucket of the first matching representative.
+// 4. assign_species_and_sorted_networks gives the networks without a match their own species, in network order.
 class species_sorter {
 private:
 	struct species_bucket_t {
-		std::atomic_flag lock = ATOMIC_FLAG_INIT;
-		debug_vector<types::network_t> networks;
+		spin_lock lock;
+		// Filled in any order, sorted by network index once all networks are sorted in.
+		debug_vector<std::pair<types::network_index_t, types::network_t>> networks;
 	};
 
 public:
-	void clear();
+	static constexpr auto candidate_chunk_size = types::network_index_t{ 128 };
+
+	// Returns the number of candidate chunks.
+	types::network_index_t clear(types::network_index_t network_count);
+
+	void find_candidates(
+		const difference_config_t& config,
+		debug_span<const types::connection_weight_t> connection_weights,
+		debug_span<const types::connection_info_t> connection_infos,
+		debug_span<const types::network_t> networks,
+		types::network_index_t chunk_index
+	);
+
+	void pick_representatives(
+		const difference_config_t& config,
+		debug_span<const types::connection_weight_t> connection_weights,
+		debug_span<const types::connection_info_t> connection_infos,
+		debug_span<const types::network_t> networks,
+		const types::network_index_t& approx_bucket_size
+	);
 
 	void sort_into_buckets(
 		const difference_config_t& config,
 		debug_span<const types::connection_weight_t> connection_weights,
 		debug_span<const types::connection_info_t> connection_infos,
 		debug_span<const types::network_t> networks,
-		const types::network_index_t& approx_bucket_size,
 		const types::network_range_t& network_range
 	);
 
 	void assign_species_and_sorted_networks(
-		debug_vector<types::species_t>& all_species, debug_span<types::network_t> networks
+		const difference_config_t& config,
+		debug_span<const types::connection_weight_t> connection_weights,
+		debug_span<const types::connection_info_t> connection_infos,
+		debug_vector<types::species_t>& all_species,
+		debug_span<types::network_t> networks
 	);
 
+	// The lookup lock guards the networks without a matching representative.
+	[[nodiscard]] spin_lock_stats_t lookup_lock_stats() const;
+
+	// Accumulated over all buckets since the last clear.
+	[[nodiscard]] spin_lock_stats_t bucket_lock_stats() const;
+
 protected:
 	types::species_index_t search_matching_network(
 		const difference_config_t& config,
@@ -38,7 +74,9 @@ protected:
 		debug_span<const types::connection_info_t> connection_infos,
 		const types::network_t& network,
 		const types::network_range_t& lookup_range
-	);
+	) const;
+
+	void add_representative(const types::network_t& network, types::network_index_t approx_bucket_size);
 
 	static float network_difference(
 		const difference_config_t& config,
@@ -49,9 +87,17 @@ protected:
 	) ;
 
 private:
-	std::atomic_flag m_lookup_lock = ATOMIC_FLAG_INIT;
-	std::deque<types::network_t> m_characteristic_networks;
+	spin_lock m_lookup_lock;
+	// Representatives are only added by the serial steps, so the workers can read them without locking.
+	debug_vector<types::network_t> m_characteristic_networks;
+	// The buckets are kept after a clear to reuse their buffers, only the first ones up to the representative count
+	// are in use.
 	std::deque<species_bucket_t> m_species_buckets;
+	// Candidates of every chunk, as network indices.
+	debug_vector<debug_vector<types::network_index_t>> m_chunk_candidates;
+	// Representatives picked from the candidates, the ones after them are added for networks without a match.
+	types::species_index_t m_picked_representative_count{};
+	debug_vector<types::network_index_t> m_unmatched_networks;
 };
 
 } // namespace neat
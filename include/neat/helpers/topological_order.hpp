@@ -0,0 +1,59 @@
+#pragma once
+
+#include "neat/types.hpp"
+
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat {
+
+// Keeps the nodes of a single loop free network ranked in topological order while connections are added.
+// A connection from a lower to a higher ranked node can never create a loop, so most checks are a single comparison.
+// Only if the ranks are out of order, the nodes ranked in between are searched and reordered
+// (Pearce and Kelly, "A Dynamic Topological Sort Algorithm for Directed Acyclic Graphs").
+// All buffers are reused between networks, so one instance per thread is enough.
+class topological_order {
+public:
+	// Starts a network with node_count nodes and no connections, the nodes are ranked by their index.
+	void reset(types::node_index_t node_count);
+
+	// Starts a network with node_count nodes and the given connections, which must not contain a loop.
+	void assign(types::node_index_t node_count, debug_span<const types::connection_t> connections);
+
+	[[nodiscard]] bool would_create_loop(types::node_index_t from, types::node_index_t to);
+
+	// Adds the connection unless it would create a loop and returns whether it was added.
+	bool try_add_connection(types::node_index_t from, types::node_index_t to);
+
+	[[nodiscard]] types::node_index_t rank(types::node_index_t node) const;
+
+private:
+	// The outgoing and incoming connections of every node are kept as linked lists through this array,
+	// so adding a connection never needs to move anything.
+	struct edge_t {
+		types::node_index_t from, to;
+		types::conn_index_t next_outgoing, next_incoming;
+	};
+
+	void add_edge(types::node_index_t from, types::node_index_t to);
+
+	// Collects all nodes reachable from 'to' that are ranked before 'from' and returns true if 'from' is reachable.
+	bool search_forward(types::node_index_t from, types::node_index_t to);
+
+	// Collects all nodes that reach 'from' and are ranked after 'to'.
+	void search_backward(types::node_index_t from, types::node_index_t to);
+
+	// Moves the nodes found by the backward search in front of the nodes found by the forward search,
+	// reusing the ranks they occupied before.
+	void reorder();
+
+	void clear_visited();
+
+	debug_vector<types::node_index_t> m_ranks;
+	debug_vector<types::conn_index_t> m_first_outgoing, m_first_incoming;
+	debug_vector<edge_t> m_edges;
+	debug_vector<bool> m_visited;
+	debug_vector<types::node_index_t> m_node_stack, m_forward_nodes, m_backward_nodes, m_affected_ranks;
+};
+
+} // namespace neat
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "neat/evolution_config.hpp"
+#include "neat/types.hpp"
+
+#include <cinttypes>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/philox_rng.hpp"
+
+namespace neat {
+
+// Identifies the random numbers used by mutate_weights.
+// Every weight draws from the counter derived from its absolute connection index,
+// so the result does not depend on how the connections are split between threads.
+struct weight_mutation_stream_t {
+	philox_rng::key_t key;
+	std::uint32_t generation;
+	std::uint32_t purpose;
+};
+
+// Perturbs each weight with probability perturbation_rate and replaces it with a new random weight otherwise.
+// The weights are processed in fixed size blocks of lanes, so random number generation and the perturb-or-replace
+// selection are branch free and can be vectorized.
+void mutate_weights(
+	const weight_distribution_config_t& distribution_config,
+	float perturbation_rate,
+	const weight_mutation_stream_t& stream,
+	types::conn_index_t first_conn_index,
+	debug_span<types::connection_weight_t> weights
+);
+
+} // namespace neat
@@ -14,6 +14,7 @@ using abs_conn_index_range_t = integer_range<abs_conn_index_t>;
 using rel_conn_index_range_t = integer_range<rel_conn_index_t>;
 
 using value_t = float;
+using output_index_t = std::uint16_t;
 
 struct weighted_connection_t {
 	static_assert(sizeof(node_index_t) == sizeof(value_t), "Sizes must be equal for efficient alignment.");
@@ -27,7 +28,7 @@ struct network_t {
 };
 
 struct network_group_t {
-	debug_vector<network_t> networks;
+	hugepage_vector<network_t> networks;
 	// After each networks incoming_connection_counts this also stores the output node lookup.
 	// | node 0  | node 1  | node 2  | output map |
 	// | 4 conns | 5 conns | 2 conns |  2  |   1  |
@@ -35,8 +36,25 @@ struct network_group_t {
 		std::numeric_limits<node_index_t>::max() <= std::numeric_limits<rel_conn_index_t>::max(),
 		"A connection index needs to be able to represent a node index (because of output node map)."
 	);
-	debug_vector<rel_conn_index_t> incoming_connection_counts_and_node_lookups;
-	debug_vector<weighted_connection_t> connections;
+	hugepage_vector<rel_conn_index_t> incoming_connection_counts_and_node_lookups;
+	hugepage_vector<weighted_connection_t> connections;
+};
+
+// Non-owning view of a network group, so evaluation works on both owned groups and mapped files.
+struct network_group_view_t {
+	network_group_view_t() = default;
+	network_group_view_t(const network_group_t& network_group);
+
+	debug_span<const network_t> networks;
+	debug_span<const rel_conn_index_t> incoming_connection_counts_and_node_lookups;
+	debug_span<const weighted_connection_t> connections;
+};
+
+// Node values of recurrent networks, which persist between evaluations.
+// The values of every network follow the node order of the compiled network.
+struct recurrent_state_t {
+	debug_vector<abs_conn_index_t> network_value_begins;
+	debug_vector<value_t> node_values;
 };
 
 } // namespace types
@@ -44,12 +62,47 @@ struct network_group_t {
 inline constexpr auto invalid_node_index = std::numeric_limits<types::node_index_t>::max();
 
 void evaluate_network_range(
-	const types::network_group_t& network_group,
+	const types::network_group_view_t& network_group,
 	debug_span<const types::value_t> inputs,
 	debug_span<types::value_t> network_outputs,
 	const neat::types::network_range_t& network_range
 );
 
+// Sets bit network_index * num_outputs + output of the decisions if the output is above the threshold, instead of
+// writing the output values. Bits of other networks stay unchanged, so ranges can be evaluated concurrently.
+void evaluate_network_range_threshold(
+	const types::network_group_view_t& network_group,
+	debug_span<const types::value_t> inputs,
+	debug_span<std::uint64_t> decisions,
+	types::value_t threshold,
+	std::size_t num_outputs,
+	const neat::types::network_range_t& network_range
+);
+
+// Stores the index of the largest output of every network, the first one if several are equal.
+void evaluate_network_range_argmax(
+	const types::network_group_view_t& network_group,
+	debug_span<const types::value_t> inputs,
+	debug_span<types::output_index_t> output_indices,
+	std::size_t num_outputs,
+	const neat::types::network_range_t& network_range
+);
+
+// Sizes the state to the network group and sets all node values to zero. Needed whenever the networks change.
+void reset_recurrent_state(const types::network_group_view_t& network_group, types::recurrent_state_t& state);
+
+// Evaluates networks compiled with recurrent connectivity. Every step updates all nodes at once from the inputs and the
+// node values of the previous step, so a signal needs one step per connection it passes.
+// Different network ranges use different parts of the state, so they can be evaluated concurrently.
+void evaluate_network_range(
+	const types::network_group_view_t& network_group,
+	types::recurrent_state_t& state,
+	debug_span<const types::value_t> inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range,
+	std::uint32_t step_count = 1
+);
+
 types::value_t activation_function(const types::value_t& signal);
 
 } // namespace neat::inference
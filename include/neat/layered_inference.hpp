@@ -0,0 +1,73 @@
+#pragma once
+
+#include "inference.hpp"
+#include "network_interface_config.hpp"
+
+#include <cinttypes>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat::inference {
+
+struct layer_config_t {
+	// A layer is stored as dense matrix once at least this portion of the entries of its matrix are connections.
+	float min_dense_density{ 0.5f };
+};
+
+namespace types {
+
+enum class layer_kind_t : std::uint8_t { sparse, dense };
+
+// Nodes that only depend on inputs and nodes of earlier layers, so the whole layer can be evaluated at once.
+// The values of a network are its inputs followed by its nodes in layer order,
+// so the nodes of a layer are consecutive.
+struct layer_t {
+	layer_kind_t kind;
+	node_index_t node_begin, node_count;
+	// A dense layer reads the values [source_begin, source_begin + source_count) through a row major
+	// node_count x source_count matrix, which starts at weights_begin.
+	node_index_t source_begin, source_count;
+	abs_conn_index_t weights_begin;
+	// A sparse layer is evaluated node by node, with one incoming connection count per node.
+	abs_conn_index_t incoming_connection_counts_begin;
+	abs_conn_index_t connections_begin;
+};
+
+struct layered_network_t {
+	abs_conn_index_range_t layers;
+	// Inputs plus nodes.
+	node_index_t value_count;
+	abs_conn_index_t output_node_lookup_begin;
+};
+
+struct layered_network_group_t {
+	debug_vector<layered_network_t> networks;
+	debug_vector<layer_t> layers;
+	debug_vector<value_t> dense_weights;
+	debug_vector<rel_conn_index_t> incoming_connection_counts;
+	debug_vector<weighted_connection_t> connections;
+	debug_vector<node_index_t> output_node_lookups;
+};
+
+} // namespace types
+
+// Splits the nodes of every network into topological layers and stores every layer as dense matrix or as sparse
+// connection lists, depending on how many of the possible connections between the layer and its sources exist.
+// Large evolved networks this way spend most of their time in small matrix vector products.
+// Only feed forward networks can be split into layers.
+void compile_layered_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	const layer_config_t& layer_config,
+	types::layered_network_group_t& layered_network_group
+);
+
+// Same inputs and outputs as the node by node evaluation of the network group the layers were compiled from.
+void evaluate_network_range(
+	const types::layered_network_group_t& network_group,
+	debug_span<const types::value_t> inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range
+);
+
+} // namespace neat::inference
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "inference.hpp"
+#include "network_interface_config.hpp"
+
+#include <array>
+#include <cinttypes>
+#include <filesystem>
+#include <system_error>
+
+namespace neat::inference {
+
+// On-disk layout of a compiled network group:
+// | header | networks | incoming_connection_counts_and_node_lookups | connections |
+// Every array starts at a multiple of file_alignment and is stored exactly like in memory,
+// so a mapped file can be handed to the evaluator without any parsing.
+struct network_group_file_header_t {
+	static constexpr auto current_version = std::uint32_t{ 1 };
+	static constexpr auto file_alignment = std::uint64_t{ 64 };
+	static constexpr auto magic_value = std::array<char, 8>{ 'N', 'E', 'A', 'T', '4', 'S', 'P', 'D' };
+
+	std::array<char, 8> magic;
+	std::uint32_t version;
+	// Element sizes of the current build, to reject files written with an incompatible layout.
+	std::uint32_t network_size, node_lookup_size, connection_size;
+	std::uint64_t input_count, output_count;
+	std::uint64_t network_offset, network_count;
+	std::uint64_t node_lookup_offset, node_lookup_count;
+	std::uint64_t connection_offset, connection_count;
+	std::uint64_t file_size;
+};
+
+enum class network_group_file_error {
+	ok = 0,
+	invalid_magic,
+	unsupported_version,
+	incompatible_layout,
+	truncated_file,
+	// A network reads node lookups, connections or node values outside of the arrays of the file.
+	corrupt_contents
+};
+
+const std::error_category& network_group_file_category();
+
+std::error_code make_error_code(network_group_file_error error);
+
+[[nodiscard]] std::error_code save_network_group(
+	const std::filesystem::path& path,
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config
+);
+
+// Read-only memory mapping of a network group file.
+// The view stays valid as long as the object is alive and mapped.
+class mapped_network_group {
+public:
+	mapped_network_group() = default;
+	mapped_network_group(const mapped_network_group&) = delete;
+	mapped_network_group(mapped_network_group&& other) noexcept;
+	mapped_network_group& operator=(const mapped_network_group&) = delete;
+	mapped_network_group& operator=(mapped_network_group&& other) noexcept;
+	~mapped_network_group();
+
+	[[nodiscard]] std::error_code map(const std::filesystem::path& path);
+
+	void unmap();
+
+	[[nodiscard]] bool is_mapped() const;
+
+	[[nodiscard]] const types::network_group_view_t& view() const;
+
+	[[nodiscard]] const network_interface_config_t& network_interface_config() const;
+
+private:
+	void* m_data{ nullptr };
+	std::size_t m_size{};
+	types::network_group_view_t m_view{};
+	network_interface_config_t m_network_interface_config{};
+};
+
+} // namespace neat::inference
+
+template<>
+struct std::is_error_code_enum<neat::inference::network_group_file_error> : public std::true_type {};
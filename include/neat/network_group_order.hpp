@@ -0,0 +1,30 @@
+#pragma once
+
+#include "inference.hpp"
+#include "network_interface_config.hpp"
+
+#include <cinttypes>
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat::inference {
+
+enum class network_order_t : std::uint8_t {
+	// Ascending by connection count, so every thread segment evaluates networks of similar cost.
+	connection_count,
+	// Ascending by node count and then connection count, so networks of the same shape are next to each other.
+	shape
+};
+
+// Copies the network group with its networks sorted by the order. The data of the networks is stored in the new order,
+// so every segment of the reordered group reads consecutive memory. Networks that compare equal keep their order.
+// original_network_indices maps every network of the reordered group to its index in the source group, inputs and
+// outputs of the reordered group are rows in the new order.
+void reorder_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	network_order_t order,
+	types::network_group_t& reordered_network_group,
+	debug_vector<neat::types::network_index_t>& original_network_indices
+);
+
+} // namespace neat::inference
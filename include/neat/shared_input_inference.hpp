@@ -0,0 +1,62 @@
+#pragma once
+
+#include "inference.hpp"
+#include "network_interface_config.hpp"
+
+#include <cinttypes>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat::inference {
+
+enum class input_source_t : std::uint8_t {
+	// Differs between networks and is passed in one row per network.
+	per_network,
+	// Same for all networks of an evaluation and passed once.
+	shared,
+	// Never changes, like a bias. Folded into the node offsets when compiling.
+	constant
+};
+
+struct input_layout_t {
+	// The source of every input of the network interface.
+	debug_vector<input_source_t> sources;
+	// The value of every constant input, indexed by input. Other entries are ignored.
+	debug_vector<types::value_t> constant_values;
+};
+
+namespace types {
+
+struct shared_input_network_group_t {
+	// Constant input connections are removed and the values of every network are its per network inputs, followed
+	// by the shared inputs and the nodes.
+	network_group_t network_group;
+	// Added to the activation of every node, parallel to incoming_connection_counts_and_node_lookups.
+	// The entries of the output node lookups are unused.
+	debug_vector<value_t> node_offsets;
+	node_index_t per_network_input_count;
+	node_index_t shared_input_count;
+};
+
+} // namespace types
+
+// Folds the connections of constant inputs into per node offsets and renumbers the remaining inputs, so evaluation
+// only has to stream the inputs that differ between networks.
+void compile_shared_input_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	const input_layout_t& input_layout,
+	types::shared_input_network_group_t& shared_input_network_group
+);
+
+// The shared inputs hold one value per shared input and the network inputs one row of per network inputs per network,
+// both in input order. The outputs are the same as with the node by node evaluation of the uncompiled group.
+void evaluate_network_range(
+	const types::shared_input_network_group_t& network_group,
+	debug_span<const types::value_t> shared_inputs,
+	debug_span<const types::value_t> network_inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range
+);
+
+} // namespace neat::inference
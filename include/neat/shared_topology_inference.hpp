@@ -0,0 +1,57 @@
+#pragma once
+
+#include "inference.hpp"
+#include "network_interface_config.hpp"
+
+#include <cinttypes>
+#include "util/debug_span.hpp" // TODO remove
+#include "util/debug_vector.hpp" // TODO remove
+
+namespace neat::inference {
+
+namespace types {
+
+// Networks with the same incoming connection counts, connection sources and output nodes, that only differ in their
+// weights. This is common inside of a species, as most offspring only mutate the weights of their ancestor.
+struct topology_t {
+	// Range of the networks using the topology in network_indices.
+	abs_conn_index_range_t networks;
+	// Incoming connection count per node, followed by the output node lookup like in the network group.
+	abs_conn_index_range_t incoming_connection_count_range;
+	abs_conn_index_t source_node_indices_begin;
+	abs_conn_index_t connection_count;
+	// Connection major connection_count x networks.size() matrix, so the weights of one connection are consecutive
+	// for all networks of the topology.
+	abs_conn_index_t weights_begin;
+};
+
+struct shared_topology_network_group_t {
+	debug_vector<topology_t> topologies;
+	// The indices of the networks in the compiled group, sorted by topology and ascending inside of every topology.
+	debug_vector<neat::types::network_index_t> network_indices;
+	debug_vector<rel_conn_index_t> incoming_connection_counts_and_node_lookups;
+	debug_vector<node_index_t> source_node_indices;
+	debug_vector<value_t> weights;
+	std::size_t network_count;
+};
+
+} // namespace types
+
+// Stores every distinct topology of the network group once, together with the weights of all networks that share it.
+void compile_shared_topology_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	types::shared_topology_network_group_t& shared_topology_network_group
+);
+
+// Same inputs and outputs as the node by node evaluation of the network group the topologies were compiled from.
+// The networks of a topology are evaluated side by side, so every connection source is decoded once per batch and the
+// weights of the batch are loaded consecutively. Networks with a topology of their own are slower than node by node.
+void evaluate_network_range(
+	const types::shared_topology_network_group_t& network_group,
+	debug_span<const types::value_t> inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range
+);
+
+} // namespace neat::inference
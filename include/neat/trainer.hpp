@@ -1,39 +1,173 @@
 #pragma once
 
 #include "evolution_config.hpp"
+#include "execution_config.hpp"
 #include "helpers/connection_lookup.hpp"
+#include "helpers/connection_sampler.hpp"
+#include "helpers/numa_topology.hpp"
+#include "helpers/phase_recorder.hpp"
 #include "helpers/species_sorter.hpp"
+#include "helpers/topological_order.hpp"
+#include "helpers/weight_mutation.hpp"
 #include "inference.hpp"
 #include "network_interface_config.hpp"
+#include "trainer_stats.hpp"
 
 #include <array>
-#include <random>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
 #include "util/debug_span.hpp" // TODO remove
 #include <system_error>
+#include <thread>
 #include "util/debug_vector.hpp" // TODO remove
+#include "util/monotonic_arena.hpp"
+#include "util/philox_rng.hpp"
 
 namespace neat {
 
 class trainer {
-	using seed_t = std::random_device::result_type;
-
 public:
+	using seed_t = std::uint64_t;
+
+	struct steady_state_network_t {
+		types::network_index_t index;
+		// Group that only contains this network, so it is evaluated as network zero.
+		const inference::types::network_group_t* network_group;
+	};
+
 	trainer(
 		const evolution_config_t& evolution_config,
 		const network_interface_config_t& network_interface_config,
 		std::size_t population_size,
-		std::uint32_t thread_count
+		std::uint32_t thread_count,
+		seed_t seed,
+		const execution_config_t& execution_config = {}
 	);
 
+	trainer(const trainer&) = delete;
+	trainer& operator=(const trainer&) = delete;
+
+	~trainer();
 
 	void evolve(debug_span<const types::fitness_t> ancestor_fitness, inference::types::network_group_t& network_group);
 
+	// Starts evolving the next generation on a background thread and returns immediately.
+	// The trainer keeps two network groups, the next generation is compiled into the one not returned last,
+	// so the previous generation can still be read until the next call. The fitness is copied.
+	void evolve_async(debug_span<const types::fitness_t> ancestor_fitness);
+
+	// Blocks until the given networks of the generation started by evolve_async are compiled.
+	// The networks are compiled in sections, so evaluation can start on the first finished sections
+	// while the remaining ones are still being compiled. Must only be called after evolve_async, if evolve
+	// was called since, the group of the last asynchronous generation is returned right away.
+	[[nodiscard]] const inference::types::network_group_t& wait_for_networks(
+		const types::network_range_t& network_range
+	);
+
+	// Blocks until the generation started by evolve_async is completely done.
+	const inference::types::network_group_t& wait_for_generation();
+
+	// Must not be called while an asynchronous evolution is running.
+	[[nodiscard]] const generation_stats_t& last_generation_stats() const;
+
+	// Places the calling thread like the trainer workers processing the given networks, depending on the numa and
+	// affinity policies. Inference workers should call this before they evaluate their networks.
+	void place_inference_worker(const types::network_range_t& network_range) const;
+
+	// Switches to the steady state mode, where there is no generation barrier. Instead, every reported fitness
+	// replaces the worst evaluated network by a single offspring, which is handed out for evaluation right away.
+	// All networks of the current population are compiled and need to be evaluated first.
+	void begin_steady_state();
+
+	// Hands out a network that still needs to be evaluated, or nothing if all of them are evaluated or taken.
+	[[nodiscard]] std::optional<steady_state_network_t> acquire_network();
+
+	// Stores the fitness of an acquired network, after which its network group must not be read anymore.
+	// Once enough networks are evaluated, the worst one is replaced and returned as the next network to evaluate.
+	// Both functions may be called from any number of threads. The offspring are built and compiled in parallel, only
+	// picking their parents and storing them is serialized.
+	[[nodiscard]] std::optional<steady_state_network_t> report_fitness(
+		types::network_index_t network_index, types::fitness_t fitness
+	);
+
+	// Networks replaced since the last call of begin_steady_state.
+	[[nodiscard]] std::uint64_t steady_state_replacement_count();
+
 protected:
+	// Every random decision draws from its own stream, addressed by generation, index and purpose.
+	// This way no generator state is shared between threads and the results don't depend on the thread count.
+	enum class rng_purpose_t : std::uint32_t {
+		sampling,
+		add_conn_mutation,
+		add_node_mutation,
+		weight_mutation,
+		weight_mutation_kernel,
+		crossover_selection,
+		crossover_survival
+	};
+
+	// The size of a crossover offspring is only known once it is created, so every crossover thread writes its
+	// offspring into its own staging buffers, which are compacted into the population afterwards.
+	// If the species reproduce in parallel, all offspring of a species are staged this way.
+	struct crossover_staging_t {
+		debug_vector<types::connection_t> connections;
+		debug_vector<types::connection_weight_t> connection_weights;
+		debug_vector<types::connection_info_t> connection_infos;
+		topological_order order;
+	};
+
+	// Everything a single steady state replacement works on, so several offspring can be built at once.
+	struct steady_state_workspace_t {
+		// Copies of the parents, as the population changes while the offspring is built.
+		types::population_t parents;
+		std::array<types::fitness_t, 2> parent_fitness;
+		types::population_t offspring;
+		// Innovation numbers are only handed out while the offspring is stored.
+		bool topological_mutation;
+		crossover_staging_t staging;
+		connection_sampler sampler;
+		monotonic_arena arena;
+	};
+
+	[[nodiscard]] philox_rng make_rng(std::uint32_t generation, rng_purpose_t purpose, std::uint32_t index) const;
+
+	[[nodiscard]] weight_mutation_stream_t weight_mutation_stream(std::uint32_t generation) const;
+
 	void create_initial_population();
 
 	void swap_population();
 
+	void evolve_generation(
+		debug_span<const types::fitness_t> ancestor_fitness, inference::types::network_group_t& network_group
+	);
+
+	void reset_compiled_networks(const inference::types::network_group_t* network_group);
+
+	void mark_networks_compiled(const types::network_range_t& network_range);
+
+	// Restricts the calling worker to the CPUs of the network, depending on the numa and affinity policies.
+	void place_worker(types::network_index_t network_index) const;
+
+	// Also resets the failed placement count.
+	[[nodiscard]] placement_stats_t placement_stats();
+
+	// Only called before the workers are started, as it creates the arena on first use.
+	[[nodiscard]] monotonic_arena& worker_arena(std::size_t worker_index);
+
+	void reset_arenas();
+
+	// Summed over the trainer and worker arenas.
+	[[nodiscard]] arena_stats_t arena_stats();
+
+	// Resizes an array that is completely overwritten afterwards. With the partitioned numa policy, the array
+	// is reallocated instead of grown, so its pages are spread over the nodes by first touch.
+	template<typename T>
+	void resize_partitioned(hugepage_vector<T>& data, std::size_t size) const;
+
 	void evolve_into(
 		const types::population_t& ancestors,
 		debug_span<const types::fitness_t> ancestor_fitness,
@@ -42,14 +176,31 @@ protected:
 
 	void update_inference_network_group(inference::types::network_group_t& network_group);
 
-private:
-	bool would_create_loop(
-		debug_span<const types::connection_t> connections,
-		const types::network_t& network,
-		const types::conn_index_t& src_index,
-		const types::conn_index_t& dst_index,
-		debug_vector<types::node_index_t>& node_stack
-	) const;
+	// Creates all offspring species by species, see execution_mode_t::species_parallel.
+	void reproduce_species_parallel(
+		const types::population_t& ancestors,
+		debug_span<const types::fitness_t> ancestor_fitness,
+		debug_span<const types::network_index_t> species_offspring_counts,
+		debug_span<const types::population_composition_t> species_offspring_compositions,
+		debug_span<const arena_vector<types::network_index_t>> species_ancestor_lookups,
+		types::population_t& offspring
+	);
+
+	// Creates the offspring of one species in the given network range and appends their connections to the staging
+	// buffers. Their weights are mutated only once they are at their final position.
+	void reproduce_species(
+		const types::population_t& ancestors,
+		debug_span<const types::fitness_t> ancestor_fitness,
+		const types::population_composition_t& species_offspring_composition,
+		debug_span<const types::network_index_t> species_ancestor_lookup,
+		debug_span<types::network_index_t> ancestor_lookup,
+		debug_span<types::network_t> offspring_networks,
+		crossover_staging_t& staging,
+		connection_sampler& sampler,
+		const types::network_range_t& species_network_range
+	);
+
+	void speciate(const types::population_t& ancestors, types::population_t& offspring);
 
 	static void calc_species_fitness(
 		debug_span<const types::species_t> all_species,
@@ -59,20 +210,23 @@ private:
 	);
 
 	void divide_offspring_between_species(
-		debug_span<const float> ancestor_species_fitness, debug_vector<types::network_index_t>& species_offspring_counts
+		debug_span<const float> ancestor_species_fitness, debug_span<types::network_index_t> species_offspring_counts
 	);
 
+	// The ancestor lookups are allocated from the given arena, so the workers don't share one.
 	void calculate_species_offspring_composition_and_sample_ancestors(
+		monotonic_arena& arena,
 		debug_span<const types::species_t> all_ancestor_species,
 		debug_span<const types::network_t> all_ancestor_networks,
 		debug_span<const float> ancestor_species_fitness,
 		debug_span<const types::network_index_t> species_offspring_counts,
 		debug_span<types::population_composition_t> offspring_species_composition,
-		debug_span<debug_vector<types::network_index_t>> species_ancestor_lookups,
+		debug_span<arena_vector<types::network_index_t>> species_ancestor_lookups,
 		const types::species_range_t& species_range
 	);
 
 	void apply_add_conn_mutations(
+		std::uint32_t generation,
 		debug_span<const types::network_t> ancestor_networks,
 		debug_span<const types::connection_t> ancestor_connections,
 		debug_span<const types::network_index_t> ancestor_lookup,
@@ -80,10 +234,12 @@ private:
 		debug_span<types::connection_t> offspring_connections,
 		debug_span<types::connection_weight_t> offspring_connection_weights,
 		debug_span<types::connection_info_t> offspring_connection_infos,
+		connection_sampler& sampler,
 		const types::network_range_t& add_conn_mutation_range
 	);
 
 	void apply_add_node_mutations(
+		std::uint32_t generation,
 		debug_span<const types::network_t> ancestor_networks,
 		debug_span<const types::connection_t> ancestor_connections,
 		debug_span<const types::connection_weight_t> ancestor_connection_weights,
@@ -95,44 +251,87 @@ private:
 		const types::network_range_t& add_node_mutation_range
 	);
 
+	void assign_innovation_numbers(
+		debug_span<const types::network_t> ancestor_networks,
+		debug_span<const types::network_index_t> ancestor_lookup,
+		debug_span<const types::network_t> offspring_networks,
+		debug_span<const types::connection_t> offspring_connections,
+		debug_span<types::connection_info_t> offspring_connection_infos,
+		const types::network_range_t& topological_mutation_range
+	);
+
 	void mutate_all_connections(
+		std::uint32_t generation,
 		debug_span<const types::network_t> offspring_networks,
 		debug_span<types::connection_weight_t> offspring_connection_weights,
 		const types::network_range_t& conn_mutation_range
 	);
 
 	void mutate_some_connections(
+		std::uint32_t generation,
 		debug_span<const types::network_t> offspring_networks,
 		debug_span<types::connection_weight_t> offspring_connection_weights,
 		const types::network_range_t& conn_mutation_range
 	);
 
+	// Appends the crossover offspring to the staging buffers, their connection ranges point into the staging buffers.
 	void create_crossovers(
+		std::uint32_t generation,
 		debug_span<const types::network_t> ancestor_networks,
 		debug_span<const types::connection_t> ancestor_connections,
 		debug_span<const types::connection_weight_t> ancestor_connection_weights,
 		debug_span<const types::connection_info_t> ancestor_connection_infos,
 		debug_span<const types::fitness_t> ancestor_fitness,
 		debug_span<const types::parents_t> parents_lookup,
-		debug_span<const seed_t> disjoint_excess_conn_selection_seeds,
+		debug_span<types::network_t> offspring_networks,
+		crossover_staging_t& staging,
+		std::size_t parents_offset,
+		const types::network_range_t& crossover_range
+	);
+
+	// Moves the crossover offspring of one staging buffer to their final position starting at staging_offset.
+	static void compact_crossovers(
+		const crossover_staging_t& staging,
+		types::conn_index_t staging_offset,
 		debug_span<types::network_t> offspring_networks,
 		debug_span<types::connection_t> offspring_connections,
 		debug_span<types::connection_weight_t> offspring_connection_weights,
 		debug_span<types::connection_info_t> offspring_connection_infos,
-		std::size_t seed_offset,
 		const types::network_range_t& crossover_range
 	);
 
-	std::size_t crossover_offspring_conn_count(
-		std::default_random_engine& disjoint_and_excess_connection_selection_engine,
-		std::uniform_int_distribution<std::uint8_t>& parents_connection_survival_distrib,
-		debug_span<const types::network_t> ancestor_networks,
-		debug_span<const types::connection_info_t> ancestor_connection_infos,
-		debug_span<const types::fitness_t> ancestor_fitness,
-		const types::parents_t& parent_indices
+	// Picks the fittest of some randomly drawn evaluated networks, skipping the excluded one.
+	[[nodiscard]] types::network_index_t select_steady_state_parent(
+		philox_rng& rng, types::network_index_t excluded
+	) const;
+
+	// Selects one parent, or two for a crossover, and copies them into the workspace. Needs the steady state mutex.
+	void select_steady_state_parents(steady_state_workspace_t& workspace, std::uint32_t generation);
+
+	// Creates a single offspring from the copied parents, so it doesn't need the steady state mutex.
+	void create_steady_state_offspring(steady_state_workspace_t& workspace, std::uint32_t generation);
+
+	// Hands out the innovation numbers of the offspring and moves it into the population. The replaced connections
+	// are only dropped once they make up half of the connection arrays. Needs the steady state mutex.
+	void store_steady_state_offspring(steady_state_workspace_t& workspace, types::network_index_t replaced_index);
+
+	void compile_steady_state_offspring(
+		steady_state_workspace_t& workspace, inference::types::network_group_t& network_group
 	);
 
+	// Temporaries are allocated from the given arena, so networks can be compiled with separate arenas at once.
 	void update_inference_network_section(
+		monotonic_arena& arena,
+		const types::population_t& generation,
+		inference::types::network_group_t& network_group,
+		const types::network_range_t& network_range,
+		types::conn_range_t& node_range,
+		types::conn_range_t& conn_range
+	);
+
+	// Recurrent networks have no topological order, so every node keeps its node index as eval index.
+	void update_recurrent_inference_network_section(
+		monotonic_arena& arena,
 		const types::population_t& generation,
 		inference::types::network_group_t& network_group,
 		const types::network_range_t& network_range,
@@ -147,13 +346,55 @@ private:
 	network_interface_config_t m_network_interface_config;
 	std::size_t m_population_size;
 	std::uint32_t m_thread_count;
+	execution_config_t m_execution_config;
+	numa_topology m_numa_topology;
+	mutable std::atomic<std::uint64_t> m_failed_placement_count{};
 
 	std::array<types::population_t, 2> m_populations;
 	std::size_t m_current_generation_index{};
+	std::uint32_t m_generation_count{};
 
-	std::default_random_engine m_rng;
+	seed_t m_seed;
+
+	// Per generation temporaries, the per thread state below is kept to reuse its buffers.
+	monotonic_arena m_arena;
+	// Every worker of a phase allocates from its own arena, so the allocations don't contend for one lock.
+	debug_vector<std::unique_ptr<monotonic_arena>> m_worker_arenas;
+	debug_vector<crossover_staging_t> m_crossover_stagings;
+	debug_vector<connection_sampler> m_connection_samplers;
 	connection_lookup m_conn_lookup;
 	species_sorter m_species_sorter;
+	phase_recorder m_phase_recorder;
+
+	// Asynchronous evolution, the compiled sections of the group being written are guarded by the mutex.
+	std::array<inference::types::network_group_t, 2> m_network_groups;
+	std::size_t m_network_group_index{};
+	debug_vector<types::fitness_t> m_async_ancestor_fitness;
+	std::thread m_evolution_thread;
+	std::mutex m_compiled_networks_mutex;
+	std::condition_variable m_compiled_networks_condition;
+	debug_vector<types::network_range_t> m_compiled_network_sections;
+	// Group and generation the sections belong to. The group is null unless an asynchronous generation was
+	// started after the last synchronous one, whose sections are not recorded.
+	const inference::types::network_group_t* m_compiled_network_group{};
+	std::uint32_t m_compiled_generation{};
+
+	enum class network_state_t : std::uint8_t { pending, evaluating, evaluated };
+
+	// Steady state evolution, everything but the groups of the handed out networks is guarded by the mutex.
+	// Every replacement counts as a generation, so it draws from its own random streams.
+	std::mutex m_steady_state_mutex;
+	debug_vector<inference::types::network_group_t> m_steady_state_network_groups;
+	debug_vector<types::fitness_t> m_steady_state_fitness;
+	debug_vector<network_state_t> m_steady_state_network_states;
+	debug_vector<types::network_index_t> m_pending_networks;
+	// Min-heap of the evaluated networks, so the worst one is found without a pass over the population.
+	debug_vector<std::pair<types::fitness_t, types::network_index_t>> m_evaluated_networks;
+	std::uint64_t m_replacement_count{};
+	types::conn_index_t m_unused_connection_count{};
+	// Workspaces not used by a replacement right now. A new one is only created if more replacements than ever
+	// before are built at once.
+	debug_vector<std::unique_ptr<steady_state_workspace_t>> m_steady_state_workspaces;
 };
 
 } // namespace neat
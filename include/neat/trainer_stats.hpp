@@ -0,0 +1,92 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <ostream>
+#include <string_view>
+#include "util/debug_vector.hpp" // TODO remove
+#include "util/monotonic_arena.hpp"
+#include "util/spin_lock.hpp"
+
+namespace neat {
+
+enum class trainer_phase_t : std::uint8_t {
+	calc_species_fitness,
+	divide_offspring,
+	sampling,
+	copying,
+	crossover,
+	mutation,
+	// Used instead of copying, crossover and mutation if the species reproduce in parallel.
+	reproduction,
+	speciation,
+	compile,
+	// Work the calling thread does alone between the parallel phases, like laying out the offspring buffers and
+	// handing out innovation numbers. Only its wall time is recorded, as no worker is busy meanwhile.
+	serial,
+	count
+};
+
+inline constexpr auto trainer_phase_count = static_cast<std::size_t>(trainer_phase_t::count);
+
+[[nodiscard]] std::string_view phase_name(trainer_phase_t phase);
+
+struct phase_stats_t {
+	// Time from the first worker starting to the last worker finishing the phase.
+	// Phases may overlap, so the wall times of all phases don't add up to the generation time.
+	std::chrono::nanoseconds wall_time{};
+	// One entry per worker that took part in the phase.
+	debug_vector<std::chrono::nanoseconds> worker_busy_times;
+	std::uint64_t item_count{};
+	// Estimate of the bytes read and written by the phase.
+	std::uint64_t bytes_touched{};
+	// Workers that finished on a different CPU than they started on, after they were placed.
+	std::uint64_t migrated_worker_count{};
+
+	[[nodiscard]] std::chrono::nanoseconds total_busy_time() const;
+	[[nodiscard]] std::chrono::nanoseconds max_busy_time() const;
+};
+
+// Only filled if the build defines NEAT_SPIN_LOCK_TELEMETRY.
+struct lock_stats_t {
+	spin_lock_stats_t connection_lookup;
+	spin_lock_stats_t species_lookup;
+	spin_lock_stats_t species_buckets;
+};
+
+struct placement_stats_t {
+	std::uint32_t numa_node_count{};
+	// Logical CPUs the workers are restricted to, zero if they can run anywhere.
+	std::uint32_t worker_cpu_count{};
+	// Whether every worker is pinned to a single CPU.
+	bool pinned{};
+	// Workers that couldn't be placed since the previous generation, including inference workers.
+	std::uint64_t failed_placement_count{};
+};
+
+struct generation_stats_t {
+	std::size_t generation_index{};
+	std::chrono::nanoseconds wall_time{};
+	types::species_index_t species_count{};
+	types::population_composition_t composition{};
+	std::array<phase_stats_t, trainer_phase_count> phases;
+	lock_stats_t lock_stats{};
+	// Allocations of the per generation temporaries, the upstream allocation count is zero in steady state.
+	arena_stats_t arena{};
+	placement_stats_t placement{};
+
+	[[nodiscard]] const phase_stats_t& phase(trainer_phase_t phase) const;
+	[[nodiscard]] phase_stats_t& phase(trainer_phase_t phase);
+};
+
+void write_json(std::ostream& out, const generation_stats_t& stats);
+
+void write_csv_header(std::ostream& out);
+
+// Writes one row per phase.
+void write_csv(std::ostream& out, const generation_stats_t& stats);
+
+} // namespace neat
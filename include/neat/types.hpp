@@ -1,5 +1,6 @@
 #pragma once
 
+#include "util/hugepage_allocator.hpp"
 #include "util/integer_range.hpp"
 
 #include <cinttypes>
@@ -55,14 +56,16 @@ struct species_t {
 
 struct population_t {
 	debug_vector<species_t> species;
-	debug_vector<network_t> networks;
-	debug_vector<connection_t> connections;
-	debug_vector<connection_weight_t> connection_weights;
-	debug_vector<connection_info_t> connection_infos;
+	// The large buffers may be backed by hugepages, as the copy phase streams through all of them.
+	hugepage_vector<network_t> networks;
+	hugepage_vector<connection_t> connections;
+	hugepage_vector<connection_weight_t> connection_weights;
+	hugepage_vector<connection_info_t> connection_infos;
 };
 } // namespace types
 
 constexpr inline auto invalid_species_index = std::numeric_limits<types::species_index_t>::max();
+constexpr inline auto invalid_network_index = std::numeric_limits<types::network_index_t>::max();
 constexpr inline auto invalid_node_index = std::numeric_limits<types::node_index_t>::max();
 constexpr inline auto invalid_conn_index = std::numeric_limits<types::conn_index_t>::max();
 constexpr inline auto invalid_innovation_number = std::numeric_limits<types::innovation_number_t>::max();
@@ -43,11 +43,11 @@ debug_span(std::array<T, N>&) -> debug_span<T, N>;
 template<class T, std::size_t N>
 debug_span(const std::array<T, N>&) -> debug_span<const T, N>;
 
-template<class T>
-debug_span(const debug_vector<T>&) -> debug_span<const T>;
+template<class T, class Allocator>
+debug_span(const debug_vector<T, Allocator>&) -> debug_span<const T>;
 
-template<class T>
-debug_span(debug_vector<T>&) -> debug_span<T>;
+template<class T, class Allocator>
+debug_span(debug_vector<T, Allocator>&) -> debug_span<T>;
 
 
 template<class R>
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <string>
+#include <string_view>
+#include "util/debug_vector.hpp" // TODO remove
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+enum class hugepage_policy_t : std::uint8_t {
+	// Large buffers are mapped with regular pages, even if transparent hugepages are enabled system wide.
+	none,
+	// Large buffers are aligned to hugepages and marked for transparent hugepages.
+	transparent,
+	// Large buffers take pages from the reserved hugepage pool (vm.nr_hugepages) and fall back to transparent
+	// hugepages once the pool is empty. Only used if set explicitly, as the pool may be reserved for other processes.
+	explicit_pages
+};
+
+enum class page_backing_t : std::uint8_t {
+	small_pages,
+	transparent_hugepages,
+	explicit_hugepages,
+	count
+};
+
+inline constexpr auto page_backing_count = static_cast<std::size_t>(page_backing_t::count);
+
+struct hugepage_stats_t {
+	// Buffers of at least one hugepage mapped since program start, indexed by page_backing_t.
+	// Smaller buffers come from the heap and are not counted.
+	std::array<std::uint64_t, page_backing_count> allocation_counts{};
+	std::array<std::uint64_t, page_backing_count> byte_counts{};
+
+	[[nodiscard]] inline std::uint64_t allocation_count(page_backing_t backing) const;
+	[[nodiscard]] inline std::uint64_t byte_count(page_backing_t backing) const;
+};
+
+// Applies to all following allocations of every hugepage_allocator. Buffers keep the backing they were mapped with.
+inline void set_hugepage_policy(hugepage_policy_t policy);
+
+[[nodiscard]] inline hugepage_policy_t hugepage_policy();
+
+[[nodiscard]] inline hugepage_stats_t hugepage_stats();
+
+[[nodiscard]] inline std::string_view page_backing_name(page_backing_t backing);
+
+// Size of the largest pages that may back a buffer of byte_count bytes. Splitting the buffer at multiples of it
+// keeps every page on one side of the split.
+[[nodiscard]] inline std::size_t backing_page_size(std::size_t byte_count);
+
+// Allocator for standard containers that maps buffers of at least one hugepage on their own, so they can be backed by
+// 2 MB pages according to the hugepage policy. Backings that are not available fall back to the next smaller one,
+// down to regular pages. Smaller buffers and other platforms use the heap.
+template<class T>
+class hugepage_allocator {
+public:
+	using value_type = T;
+
+	hugepage_allocator() = default;
+
+	template<class U>
+	inline hugepage_allocator(const hugepage_allocator<U>&);
+
+	[[nodiscard]] inline T* allocate(std::size_t count);
+
+	inline void deallocate(T* data, std::size_t count);
+
+	template<class U>
+	[[nodiscard]] inline bool operator==(const hugepage_allocator<U>&) const;
+};
+
+template<class T>
+using hugepage_vector = debug_vector<T, hugepage_allocator<T>>;
+
+
+//--------------------[ hugepage mappings ]--------------------//
+
+namespace hugepage_detail {
+
+inline constexpr auto hugepage_size = std::size_t{ 2 * 1024 * 1024 };
+
+struct state_t {
+	std::atomic<hugepage_policy_t> policy{ hugepage_policy_t::transparent };
+	std::array<std::atomic<std::uint64_t>, page_backing_count> allocation_counts{};
+	std::array<std::atomic<std::uint64_t>, page_backing_count> byte_counts{};
+};
+
+inline state_t state;
+
+inline std::size_t mapping_size(const std::size_t byte_count) {
+	return (byte_count + hugepage_size - 1) / hugepage_size * hugepage_size;
+}
+
+inline void record_mapping(const page_backing_t backing, const std::size_t byte_count) {
+	const auto index = static_cast<std::size_t>(backing);
+	state.allocation_counts[index].fetch_add(1, std::memory_order_relaxed);
+	state.byte_counts[index].fetch_add(byte_count, std::memory_order_relaxed);
+}
+
+#ifdef __linux__
+// The kernel accepts MADV_HUGEPAGE even if transparent hugepages are disabled, so the sysfs setting is read once.
+inline bool transparent_hugepages_enabled() {
+	static const auto enabled = []() {
+		auto file = std::ifstream("/sys/kernel/mm/transparent_hugepage/enabled");
+		auto setting = std::string{};
+		std::getline(file, setting);
+		return setting.find("[always]") != std::string::npos or setting.find("[madvise]") != std::string::npos;
+	}();
+	return enabled;
+}
+
+inline void* map(const std::size_t byte_count) {
+	const auto size = mapping_size(byte_count);
+	const auto policy = state.policy.load(std::memory_order_relaxed);
+
+	if (policy == hugepage_policy_t::explicit_pages) {
+		auto flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+		// Without the size the default hugepage size is used, which may be 1 GB.
+		flags |= 21 << MAP_HUGE_SHIFT;
+#endif
+		auto* const data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+		if (data != MAP_FAILED) {
+			record_mapping(page_backing_t::explicit_hugepages, size);
+			return data;
+		}
+	}
+
+	// Only aligned 2 MB ranges can become transparent hugepages, so one extra page is mapped to cut off the
+	// unaligned ends.
+	auto* const mapping = ::mmap(
+		nullptr, size + hugepage_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+	);
+	if (mapping == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+
+	const auto address = reinterpret_cast<std::uintptr_t>(mapping);
+	const auto aligned_address = (address + hugepage_size - 1) / hugepage_size * hugepage_size;
+	const auto head_size = aligned_address - address;
+	if (head_size != 0) {
+		::munmap(mapping, head_size);
+	}
+	if (head_size != hugepage_size) {
+		::munmap(reinterpret_cast<void*>(aligned_address + size), hugepage_size - head_size);
+	}
+
+	auto* const data = reinterpret_cast<void*>(aligned_address);
+	auto backing = page_backing_t::small_pages;
+	if (policy == hugepage_policy_t::none) {
+		::madvise(data, size, MADV_NOHUGEPAGE);
+	} else if (transparent_hugepages_enabled() and ::madvise(data, size, MADV_HUGEPAGE) == 0) {
+		backing = page_backing_t::transparent_hugepages;
+	}
+
+	record_mapping(backing, size);
+	return data;
+}
+
+inline void unmap(void* const data, const std::size_t byte_count) {
+	::munmap(data, mapping_size(byte_count));
+}
+#endif
+
+} // namespace hugepage_detail
+
+void set_hugepage_policy(const hugepage_policy_t policy) {
+	hugepage_detail::state.policy.store(policy, std::memory_order_relaxed);
+}
+
+hugepage_policy_t hugepage_policy() {
+	return hugepage_detail::state.policy.load(std::memory_order_relaxed);
+}
+
+hugepage_stats_t hugepage_stats() {
+	auto stats = hugepage_stats_t{};
+	for (std::size_t backing{}; backing != page_backing_count; ++backing) {
+		stats.allocation_counts[backing] = hugepage_detail::state.allocation_counts[backing].load(
+			std::memory_order_relaxed
+		);
+		stats.byte_counts[backing] = hugepage_detail::state.byte_counts[backing].load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+std::string_view page_backing_name(const page_backing_t backing) {
+	switch (backing) {
+	case page_backing_t::small_pages:
+		return "small_pages";
+	case page_backing_t::transparent_hugepages:
+		return "transparent_hugepages";
+	case page_backing_t::explicit_hugepages:
+		return "explicit_hugepages";
+	default:
+		return "unknown";
+	}
+}
+
+std::size_t backing_page_size(const std::size_t byte_count) {
+#ifdef __linux__
+	if (byte_count >= hugepage_detail::hugepage_size) {
+		return hugepage_detail::hugepage_size;
+	}
+	return static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#else
+	static_cast<void>(byte_count);
+	return 4096;
+#endif
+}
+
+
+//--------------------[ hugepage_stats_t ]--------------------//
+
+std::uint64_t hugepage_stats_t::allocation_count(const page_backing_t backing) const {
+	return allocation_counts[static_cast<std::size_t>(backing)];
+}
+
+std::uint64_t hugepage_stats_t::byte_count(const page_backing_t backing) const {
+	return byte_counts[static_cast<std::size_t>(backing)];
+}
+
+
+//--------------------[ hugepage_allocator ]--------------------//
+
+template<class T>
+template<class U>
+hugepage_allocator<T>::hugepage_allocator(const hugepage_allocator<U>&) {
+}
+
+template<class T>
+T* hugepage_allocator<T>::allocate(const std::size_t count) {
+	const auto byte_count = count * sizeof(T);
+#ifdef __linux__
+	// The size decides between mapping and heap, so deallocate can tell them apart without storing anything.
+	if (byte_count >= hugepage_detail::hugepage_size) {
+		return static_cast<T*>(hugepage_detail::map(byte_count));
+	}
+#endif
+	return static_cast<T*>(::operator new(byte_count, std::align_val_t{ alignof(T) }));
+}
+
+template<class T>
+void hugepage_allocator<T>::deallocate(T* const data, const std::size_t count) {
+	const auto byte_count = count * sizeof(T);
+#ifdef __linux__
+	if (byte_count >= hugepage_detail::hugepage_size) {
+		hugepage_detail::unmap(data, byte_count);
+		return;
+	}
+#endif
+	::operator delete(data, std::align_val_t{ alignof(T) });
+}
+
+template<class T>
+template<class U>
+bool hugepage_allocator<T>::operator==(const hugepage_allocator<U>&) const {
+	return true;
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <cinttypes>
 #include <ranges>
 #include <span>
@@ -46,18 +48,18 @@ struct integer_range {
 	template<typename T>
 	[[nodiscard]] inline debug_span<T> span(debug_span<T> range) const;
 
-	template<typename T>
-	[[nodiscard]] inline debug_span<const T> span(const debug_vector<T>& range) const;
+	template<typename T, typename Allocator>
+	[[nodiscard]] inline debug_span<const T> span(const debug_vector<T, Allocator>& range) const;
 
-	template<typename T>
-	[[nodiscard]] inline debug_span<T> span(debug_vector<T>& range) const;
+	template<typename T, typename Allocator>
+	[[nodiscard]] inline debug_span<T> span(debug_vector<T, Allocator>& range) const;
 
 
 	template<typename T>
 	[[nodiscard]] inline debug_span<const T> cspan(debug_span<T> range) const;
 
-	template<typename T>
-	[[nodiscard]] inline debug_span<const T> cspan(const debug_vector<T>& range) const;
+	template<typename T, typename Allocator>
+	[[nodiscard]] inline debug_span<const T> cspan(const debug_vector<T, Allocator>& range) const;
 
 	[[nodiscard]] inline balanced_segments_t<Integer> balanced_segments(std::size_t segment_count) const;
 	[[nodiscard]] inline fixed_segments_t<Integer> fixed_segments(Integer segment_size) const;
@@ -442,16 +444,16 @@ template<typename T>
 }
 
 template<typename Integer>
-template<typename T>
-[[nodiscard]] debug_span<const T> integer_range<Integer>::span(const debug_vector<T>& range) const {
+template<typename T, typename Allocator>
+[[nodiscard]] debug_span<const T> integer_range<Integer>::span(const debug_vector<T, Allocator>& range) const {
 	assert(m_begin == m_end or m_begin < range.size());
 	assert(m_end <= range.size());
 	return debug_span<const T>(range.begin() + m_begin, range.begin() + m_end);
 }
 
 template<typename Integer>
-template<typename T>
-[[nodiscard]] debug_span<T> integer_range<Integer>::span(debug_vector<T>& range) const {
+template<typename T, typename Allocator>
+[[nodiscard]] debug_span<T> integer_range<Integer>::span(debug_vector<T, Allocator>& range) const {
 	assert(m_begin == m_end or m_begin < range.size());
 	assert(m_end <= range.size());
 	return debug_span<T>(range.begin() + m_begin, range.begin() + m_end);
@@ -466,8 +468,8 @@ template<typename T>
 }
 
 template<typename Integer>
-template<typename T>
-[[nodiscard]] debug_span<const T> integer_range<Integer>::cspan(const debug_vector<T>& range) const {
+template<typename T, typename Allocator>
+[[nodiscard]] debug_span<const T> integer_range<Integer>::cspan(const debug_vector<T, Allocator>& range) const {
 	return this->span(range);
 }
 
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "util/debug_vector.hpp" // TODO remove
+#include "util/spin_lock.hpp"
+
+struct arena_stats_t {
+	// Blocks requested from the heap since the last reset. Stays zero once the arena reached its steady state size.
+	std::uint64_t upstream_allocation_count{};
+	std::uint64_t bytes_used{};
+	std::uint64_t capacity{};
+};
+
+// Hands out memory by bumping an offset and releases all of it at once on reset.
+// The blocks are kept between resets. If one cycle needed several blocks, they are merged into one that fits the
+// whole cycle, so repeating the same allocations doesn't touch the heap anymore.
+// Allocations are guarded by a spin lock, so worker threads can share one arena.
+class monotonic_arena {
+public:
+	monotonic_arena() = default;
+
+	monotonic_arena(const monotonic_arena&) = delete;
+	monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+	[[nodiscard]] inline void* allocate(std::size_t size, std::size_t alignment);
+
+	// Invalidates all memory handed out since the last reset.
+	inline void reset();
+
+	[[nodiscard]] inline arena_stats_t stats();
+
+private:
+	struct block_t {
+		std::unique_ptr<std::byte[]> data;
+		std::size_t size;
+	};
+
+	static constexpr auto min_block_size = std::size_t{ 64 * 1024 };
+
+	inline void add_block(std::size_t size);
+
+	spin_lock m_lock;
+	debug_vector<block_t> m_blocks;
+	std::size_t m_block_offset{};
+	arena_stats_t m_stats{};
+};
+
+// Allocator for standard containers, deallocation is a no-op as the memory is released by resetting the arena.
+template<class T>
+class arena_allocator {
+public:
+	using value_type = T;
+	// Moved containers keep their memory, which stays valid until the arena it came from is reset.
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::true_type;
+
+	inline explicit arena_allocator(monotonic_arena& arena);
+
+	template<class U>
+	inline arena_allocator(const arena_allocator<U>& other);
+
+	[[nodiscard]] inline T* allocate(std::size_t count);
+
+	inline void deallocate(T*, std::size_t);
+
+	[[nodiscard]] inline monotonic_arena& arena() const;
+
+	template<class U>
+	[[nodiscard]] inline bool operator==(const arena_allocator<U>& other) const;
+
+private:
+	monotonic_arena* m_arena;
+};
+
+template<class T>
+using arena_vector = debug_vector<T, arena_allocator<T>>;
+
+
+//--------------------[ monotonic_arena ]--------------------//
+
+void* monotonic_arena::allocate(const std::size_t size, const std::size_t alignment) {
+	m_lock.lock();
+
+	const auto aligned_offset = [&]() {
+		const auto address = reinterpret_cast<std::uintptr_t>(m_blocks.back().data.get()) + m_block_offset;
+		return m_block_offset + (alignment - address % alignment) % alignment;
+	};
+
+	// Blocks are only appended, so the last one is the current one.
+	if (m_blocks.empty() or aligned_offset() + size > m_blocks.back().size) {
+		add_block(size + alignment);
+	}
+
+	const auto offset = aligned_offset();
+	auto* memory = m_blocks.back().data.get() + offset;
+	m_stats.bytes_used += offset + size - m_block_offset;
+	m_block_offset = offset + size;
+
+	m_lock.unlock();
+
+	return memory;
+}
+
+void monotonic_arena::reset() {
+	m_lock.lock();
+
+	m_stats.upstream_allocation_count = 0;
+	m_stats.bytes_used = 0;
+
+	// The merged block is counted as an allocation of the new cycle.
+	if (m_blocks.size() > 1) {
+		const auto capacity = m_stats.capacity;
+		m_blocks.clear();
+		m_stats.capacity = 0;
+		add_block(capacity);
+	}
+
+	m_block_offset = 0;
+
+	m_lock.unlock();
+}
+
+arena_stats_t monotonic_arena::stats() {
+	m_lock.lock();
+	const auto stats = m_stats;
+	m_lock.unlock();
+	return stats;
+}
+
+void monotonic_arena::add_block(const std::size_t size) {
+	// Growing geometrically keeps the number of blocks per cycle logarithmic.
+	const auto block_size = std::max({ size, m_stats.capacity, min_block_size });
+
+	m_blocks.push_back({ .data = std::make_unique_for_overwrite<std::byte[]>(block_size), .size = block_size });
+	m_block_offset = 0;
+
+	m_stats.capacity += block_size;
+	++m_stats.upstream_allocation_count;
+}
+
+
+//--------------------[ arena_allocator ]--------------------//
+
+template<class T>
+arena_allocator<T>::arena_allocator(monotonic_arena& arena) : m_arena{ &arena } {
+}
+
+template<class T>
+template<class U>
+arena_allocator<T>::arena_allocator(const arena_allocator<U>& other) : m_arena{ &other.arena() } {
+}
+
+template<class T>
+T* arena_allocator<T>::allocate(const std::size_t count) {
+	return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+}
+
+template<class T>
+void arena_allocator<T>::deallocate(T*, std::size_t) {
+}
+
+template<class T>
+monotonic_arena& arena_allocator<T>::arena() const {
+	return *m_arena;
+}
+
+template<class T>
+template<class U>
+bool arena_allocator<T>::operator==(const arena_allocator<U>& other) const {
+	return m_arena == &other.arena();
+}
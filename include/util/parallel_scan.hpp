@@ -0,0 +1,104 @@
+#pragma once
+
+#include "util/integer_range.hpp"
+
+#include <barrier>
+#include <cinttypes>
+#include <memory>
+#include <thread>
+#include "util/debug_vector.hpp" // TODO remove
+
+// Below this many elements the threads cost more than they save, so the scan runs on the calling thread.
+inline constexpr auto min_parallel_scan_size = std::size_t{ 1 } << 14;
+
+// Exclusive prefix sum over a range of indices, which scales with the thread count.
+// `count(index)` returns the value of an index and `assign(index, offset)` receives the sum of all values before it,
+// starting at `init`. Returns the sum of all values plus `init`.
+// Every thread sums its segment, the segment sums are scanned and then every thread scans its segment again.
+// So `count` is called twice per index and has to be cheap and free of side effects.
+// The allocator is used for the thread handles and segment sums.
+template<
+	typename Integer,
+	typename Value,
+	typename Count,
+	typename Assign,
+	class Allocator = std::allocator<std::byte>>
+inline Value parallel_exclusive_scan(
+	const integer_range<Integer>& range,
+	Value init,
+	std::uint32_t thread_count,
+	Count&& count,
+	Assign&& assign,
+	const Allocator& allocator = Allocator{}
+);
+
+
+//--------------------[ parallel_exclusive_scan ]--------------------//
+
+template<typename Integer, typename Value, typename Count, typename Assign, class Allocator>
+Value parallel_exclusive_scan(
+	const integer_range<Integer>& range,
+	const Value init,
+	const std::uint32_t thread_count,
+	Count&& count,
+	Assign&& assign,
+	const Allocator& allocator
+) {
+	const auto scan_segment = [&](const integer_range<Integer>& segment, Value offset) {
+		for (const auto& index : segment.indices()) {
+			const auto value = count(index);
+			assign(index, offset);
+			offset += value;
+		}
+		return offset;
+	};
+
+	if (thread_count <= 1 or range.size() < min_parallel_scan_size) {
+		return scan_segment(range, init);
+	}
+
+	using value_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<Value>;
+	using thread_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<std::thread>;
+
+	const auto segments = range.balanced_segments(thread_count);
+
+	// Holds the segment sums until the barrier turns them into the segment offsets.
+	debug_vector<Value, value_allocator_t> segment_offsets(thread_count, Value{}, value_allocator_t(allocator));
+	auto total = init;
+
+	auto segment_sums_done = std::barrier(thread_count, [&]() noexcept {
+		for (auto& segment_offset : segment_offsets) {
+			const auto segment_sum = segment_offset;
+			segment_offset = total;
+			total += segment_sum;
+		}
+	});
+
+	const auto scan_thread_segment = [&](const std::uint32_t thread_index) {
+		const auto segment = segments[thread_index];
+
+		auto segment_sum = Value{};
+		for (const auto& index : segment.indices()) {
+			segment_sum += count(index);
+		}
+		segment_offsets[thread_index] = segment_sum;
+
+		segment_sums_done.arrive_and_wait();
+
+		scan_segment(segment, segment_offsets[thread_index]);
+	};
+
+	// The calling thread takes the first segment.
+	debug_vector<std::thread, thread_allocator_t> threads{ thread_allocator_t(allocator) };
+	threads.reserve(thread_count - 1);
+	for (std::uint32_t thread_index{ 1 }; thread_index != thread_count; ++thread_index) {
+		threads.emplace_back(scan_thread_segment, thread_index);
+	}
+	scan_thread_segment(0);
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	return total;
+}
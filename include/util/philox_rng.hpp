@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <limits>
+
+// Counter based random number generator (Philox4x32-10, Salmon et al. "Parallel Random Numbers: As Easy as 1, 2, 3").
+// Every value is a pure function of key and counter, so independent streams can be created anywhere without
+// sharing state, just by choosing distinct stream words.
+// Satisfies UniformRandomBitGenerator, so it can be used with the standard distributions.
+class philox_rng {
+public:
+	using result_type = std::uint32_t;
+	using key_t = std::array<std::uint32_t, 2>;
+	// The first word counts the generated blocks, the other three select the stream.
+	using counter_t = std::array<std::uint32_t, 4>;
+
+	inline philox_rng(std::uint64_t key, std::uint32_t stream_a, std::uint32_t stream_b, std::uint32_t stream_c);
+
+	[[nodiscard]] inline static constexpr result_type min();
+
+	[[nodiscard]] inline static constexpr result_type max();
+
+	inline result_type operator()();
+
+	inline void discard(unsigned long long count);
+
+	// Stateless access to a single block of four random words.
+	[[nodiscard]] inline static constexpr counter_t block(key_t key, counter_t counter);
+
+	// Same as block, but for several counters at once, which lets the compiler vectorize the rounds.
+	// The words are returned interleaved: all first words, then all second words and so on.
+	template<std::size_t Count>
+	[[nodiscard]] inline static constexpr std::array<std::array<std::uint32_t, Count>, 4> blocks(
+		key_t key, const std::array<counter_t, Count>& counters
+	);
+
+	[[nodiscard]] inline static constexpr key_t make_key(std::uint64_t key);
+
+private:
+	static constexpr auto block_size = std::tuple_size_v<counter_t>;
+
+	key_t m_key;
+	counter_t m_counter;
+	counter_t m_block{};
+	std::uint32_t m_block_index{ block_size };
+};
+
+
+//--------------------[ philox_rng ]--------------------//
+
+philox_rng::philox_rng(
+	const std::uint64_t key, const std::uint32_t stream_a, const std::uint32_t stream_b, const std::uint32_t stream_c
+) :
+	m_key{ make_key(key) }, m_counter{ 0, stream_a, stream_b, stream_c } {
+}
+
+constexpr philox_rng::result_type philox_rng::min() {
+	return std::numeric_limits<result_type>::min();
+}
+
+constexpr philox_rng::result_type philox_rng::max() {
+	return std::numeric_limits<result_type>::max();
+}
+
+philox_rng::result_type philox_rng::operator()() {
+	if (m_block_index == block_size) {
+		m_block = block(m_key, m_counter);
+		++m_counter[0];
+		m_block_index = 0;
+	}
+	return m_block[m_block_index++];
+}
+
+void philox_rng::discard(unsigned long long count) {
+	// Skip whole blocks without generating them.
+	const auto buffered_count = static_cast<unsigned long long>(block_size - m_block_index);
+	if (count <= buffered_count) {
+		m_block_index += static_cast<std::uint32_t>(count);
+		return;
+	}
+	count -= buffered_count;
+	m_counter[0] += static_cast<std::uint32_t>(count / block_size);
+	m_block_index = block_size;
+	for (auto i = count % block_size; i != 0; --i) {
+		operator()();
+	}
+}
+
+constexpr philox_rng::counter_t philox_rng::block(key_t key, counter_t counter) {
+	constexpr auto multiplier_0 = std::uint64_t{ 0xD2511F53 }, multiplier_1 = std::uint64_t{ 0xCD9E8D57 };
+	constexpr auto weyl_0 = std::uint32_t{ 0x9E3779B9 }, weyl_1 = std::uint32_t{ 0xBB67AE85 };
+	constexpr auto round_count = 10;
+
+	for (int i{}; i != round_count; ++i) {
+		const auto product_0 = multiplier_0 * counter[0];
+		const auto product_1 = multiplier_1 * counter[2];
+
+		counter = { static_cast<std::uint32_t>(product_1 >> 32) ^ counter[1] ^ key[0],
+			        static_cast<std::uint32_t>(product_1),
+			        static_cast<std::uint32_t>(product_0 >> 32) ^ counter[3] ^ key[1],
+			        static_cast<std::uint32_t>(product_0) };
+
+		key[0] += weyl_0;
+		key[1] += weyl_1;
+	}
+
+	return counter;
+}
+
+template<std::size_t Count>
+constexpr std::array<std::array<std::uint32_t, Count>, 4> philox_rng::blocks(
+	key_t key, const std::array<counter_t, Count>& counters
+) {
+	constexpr auto multiplier_0 = std::uint64_t{ 0xD2511F53 }, multiplier_1 = std::uint64_t{ 0xCD9E8D57 };
+	constexpr auto weyl_0 = std::uint32_t{ 0x9E3779B9 }, weyl_1 = std::uint32_t{ 0xBB67AE85 };
+	constexpr auto round_count = 10;
+
+	using lanes_t = std::array<std::uint32_t, Count>;
+
+	lanes_t words_0, words_1, words_2, words_3;
+	for (std::size_t i{}; i != Count; ++i) {
+		words_0[i] = counters[i][0];
+		words_1[i] = counters[i][1];
+		words_2[i] = counters[i][2];
+		words_3[i] = counters[i][3];
+	}
+
+	// Rounds write into separate arrays, in place updates keep the compiler from vectorizing the multiplications.
+	lanes_t next_0, next_1, next_2, next_3;
+	for (int round{}; round != round_count; ++round) {
+		for (std::size_t i{}; i != Count; ++i) {
+			const auto product_0 = multiplier_0 * words_0[i];
+			const auto product_1 = multiplier_1 * words_2[i];
+
+			next_0[i] = static_cast<std::uint32_t>(product_1 >> 32) ^ words_1[i] ^ key[0];
+			next_1[i] = static_cast<std::uint32_t>(product_1);
+			next_2[i] = static_cast<std::uint32_t>(product_0 >> 32) ^ words_3[i] ^ key[1];
+			next_3[i] = static_cast<std::uint32_t>(product_0);
+		}
+		words_0 = next_0;
+		words_1 = next_1;
+		words_2 = next_2;
+		words_3 = next_3;
+
+		key[0] += weyl_0;
+		key[1] += weyl_1;
+	}
+
+	return { words_0, words_1, words_2, words_3 };
+}
+
+constexpr philox_rng::key_t philox_rng::make_key(const std::uint64_t key) {
+	return { static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32) };
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <thread>
+
+// Wait policies that can be selected at compile time via NEAT_SPIN_LOCK_POLICY.
+#define NEAT_SPIN_POLICY_BUSY 0
+#define NEAT_SPIN_POLICY_PAUSE 1
+#define NEAT_SPIN_POLICY_YIELD 2
+#define NEAT_SPIN_POLICY_BACKOFF 3
+
+#ifndef NEAT_SPIN_LOCK_POLICY
+#define NEAT_SPIN_LOCK_POLICY NEAT_SPIN_POLICY_BUSY
+#endif
+
+// Define NEAT_SPIN_LOCK_TELEMETRY to count acquisitions, failed attempts and spin time of every lock.
+#ifdef NEAT_SPIN_LOCK_TELEMETRY
+inline constexpr auto spin_lock_telemetry_enabled = true;
+#else
+inline constexpr auto spin_lock_telemetry_enabled = false;
+#endif
+
+enum class spin_policy_t : std::uint8_t {
+	busy = NEAT_SPIN_POLICY_BUSY,
+	pause = NEAT_SPIN_POLICY_PAUSE,
+	yield = NEAT_SPIN_POLICY_YIELD,
+	backoff = NEAT_SPIN_POLICY_BACKOFF
+};
+
+inline constexpr auto spin_policy = static_cast<spin_policy_t>(NEAT_SPIN_LOCK_POLICY);
+
+struct spin_lock_stats_t {
+	std::uint64_t acquisitions{};
+	std::uint64_t failed_attempts{};
+	std::chrono::nanoseconds spin_time{};
+
+	inline spin_lock_stats_t& operator+=(const spin_lock_stats_t& other);
+};
+
+class spin_lock {
+public:
+	inline void lock();
+
+	[[nodiscard]] inline bool try_lock();
+
+	inline void unlock();
+
+	// Only meaningful when no thread holds or waits for the lock.
+	[[nodiscard]] inline spin_lock_stats_t stats() const;
+
+	inline void reset_stats();
+
+private:
+	inline static void wait(std::uint32_t attempt);
+
+	std::atomic_flag m_flag = ATOMIC_FLAG_INIT;
+	// Only modified while holding the lock and only if telemetry is enabled.
+	spin_lock_stats_t m_stats;
+};
+
+
+//--------------------[ spin_lock_stats_t ]--------------------//
+
+spin_lock_stats_t& spin_lock_stats_t::operator+=(const spin_lock_stats_t& other) {
+	acquisitions += other.acquisitions;
+	failed_attempts += other.failed_attempts;
+	spin_time += other.spin_time;
+	return *this;
+}
+
+
+//--------------------[ spin_lock ]--------------------//
+
+void spin_lock::lock() {
+	if (not m_flag.test_and_set(std::memory_order_acquire)) [[likely]] {
+		if constexpr (spin_lock_telemetry_enabled) {
+			++m_stats.acquisitions;
+		}
+		return;
+	}
+
+	// The clock is only read on contention, so uncontended acquisitions stay cheap.
+	using clock_t = std::chrono::steady_clock;
+	[[maybe_unused]] const auto spin_begin = spin_lock_telemetry_enabled ? clock_t::now() : clock_t::time_point{};
+
+	auto failed_attempts = std::uint64_t{};
+	auto attempt = std::uint32_t{};
+	do {
+		++failed_attempts;
+		// Wait on a plain load to not bounce the cache line between waiting cores.
+		while (m_flag.test(std::memory_order_relaxed)) {
+			wait(attempt++);
+		}
+	} while (m_flag.test_and_set(std::memory_order_acquire));
+
+	if constexpr (spin_lock_telemetry_enabled) {
+		++m_stats.acquisitions;
+		m_stats.failed_attempts += failed_attempts;
+		m_stats.spin_time += clock_t::now() - spin_begin;
+	}
+}
+
+bool spin_lock::try_lock() {
+	const auto acquired = not m_flag.test_and_set(std::memory_order_acquire);
+	if (spin_lock_telemetry_enabled and acquired) {
+		++m_stats.acquisitions;
+	}
+	return acquired;
+}
+
+void spin_lock::unlock() {
+	m_flag.clear(std::memory_order_release);
+}
+
+spin_lock_stats_t spin_lock::stats() const {
+	return m_stats;
+}
+
+void spin_lock::reset_stats() {
+	m_stats = {};
+}
+
+void spin_lock::wait(const std::uint32_t attempt) {
+	const auto pause = []() {
+#if defined(__x86_64__) or defined(__i386__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__)
+		asm volatile("yield");
+#endif
+	};
+
+	if constexpr (spin_policy == spin_policy_t::pause) {
+		pause();
+	} else if constexpr (spin_policy == spin_policy_t::yield) {
+		std::this_thread::yield();
+	} else if constexpr (spin_policy == spin_policy_t::backoff) {
+		// Exponentially growing pause bursts, until giving up the time slice is cheaper.
+		static constexpr auto max_backoff_exponent = std::uint32_t{ 6 };
+		if (attempt < max_backoff_exponent) {
+			for (auto i = std::uint32_t{}; i != (std::uint32_t{ 1 } << attempt); ++i) {
+				pause();
+			}
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
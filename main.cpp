@@ -1,12 +1,19 @@
 
 #include "flappy_birds/game_engine.hpp"
+#include "neat/fitness_accumulator.hpp"
+#include "neat/network_group_file.hpp"
+#include "neat/shared_input_inference.hpp"
 #include "neat/trainer.hpp"
 
 #include <SFML/Window/Event.hpp>
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <random>
 #include <thread>
 
 int main() {
@@ -19,9 +26,11 @@ int main() {
 	const auto dt = std::chrono::duration_cast<seconds_t>(frame_time).count(); // 2.0f;
 	const auto stop_score = 100;
 
-	// Network Inputs
-	static constexpr auto dist_gap_y_index{ 0 }, dist_pipe_x_index{ 1 }, dist_to_ceiling_y{ 2 }, dist_to_floor_y{ 2 },
-		bias_index{ 3 };
+	// Network Inputs, the gap, ceiling and floor distances differ per bird and fill the other inputs in this order.
+	static constexpr auto dist_pipe_x_index{ 1 }, bias_index{ 4 };
+	// Only the inputs that differ between birds are passed per bird, the others are left out of the rows.
+	static constexpr auto bird_dist_gap_y_index{ 0 }, bird_dist_to_ceiling_y{ 1 }, bird_dist_to_floor_y{ 2 },
+		bird_input_count{ 3 };
 
 	const auto evolution_config = neat::evolution_config_t{};
 	const auto interface_config = neat::network_interface_config_t{ .input_count = 5, .output_count = 1 };
@@ -29,13 +38,35 @@ int main() {
 	const auto population_size = 10'000;
 	const auto thread_count = std::thread::hardware_concurrency();
 
-	neat::trainer flappy_trainer(evolution_config, interface_config, population_size, thread_count);
+	neat::trainer flappy_trainer(
+		evolution_config,
+		interface_config,
+		population_size,
+		thread_count,
+		std::random_device{}()
+	);
 	neat::inference::types::network_group_t inference_networks;
 
-	debug_vector<float> inputs(population_size * interface_config.input_count);
+	// The pipe distance is the same for all birds and the bias is folded into the node offsets when compiling.
+	auto input_layout = neat::inference::input_layout_t{
+		.sources = debug_vector<neat::inference::input_source_t>(
+			interface_config.input_count,
+			neat::inference::input_source_t::per_network
+		),
+		.constant_values = debug_vector<float>(interface_config.input_count, 0.0f)
+	};
+	input_layout.sources[dist_pipe_x_index] = neat::inference::input_source_t::shared;
+	input_layout.sources[bias_index] = neat::inference::input_source_t::constant;
+	input_layout.constant_values[bias_index] = 1.0f;
+	neat::inference::types::shared_input_network_group_t shared_input_networks;
+
+	debug_vector<float> inputs(population_size * bird_input_count);
+	std::array<float, 1> shared_inputs;
 	debug_vector<float> outputs(population_size * interface_config.output_count);
 
-	debug_vector<neat::types::fitness_t> fitness(population_size, 0.0f);
+	// All birds play in the same game, so terminating single networks early wouldn't save anything here.
+	neat::fitness_accumulator fitness;
+	fitness.reset(population_size);
 	debug_vector<float> results(population_size);
 
 	const auto game_config = flappy_birds::game_logic::config_t{};
@@ -49,7 +80,6 @@ int main() {
 	);
 
 	const auto game_batch_size = 10;
-	const auto batch_scale = 1.0f / static_cast<float>(game_batch_size);
 
 	std::atomic_flag stop_training = ATOMIC_FLAG_INIT;
 
@@ -71,28 +101,34 @@ int main() {
 
 		const auto next_gap_y = game_state.pipe_gaps_y[game_config.pipes_behind_bird];
 
+		shared_inputs[0] = game_state.pipe_position_x;
+
 		for (std::size_t i{}; i != game_state.bird_states.size(); ++i) {
 
 			const auto& bird_state = game_state.bird_states[i];
 
 			const auto bird_index = game_state.active_bird_indices[i];
-			const auto bird_inputs = inputs.begin() + bird_index * interface_config.input_count;
-
-			bird_inputs[dist_gap_y_index] = next_gap_y - bird_state.position_y;
+			const auto bird_inputs = inputs.begin() + bird_index * bird_input_count;
 
-			bird_inputs[dist_pipe_x_index] = game_state.pipe_position_x;
+			bird_inputs[bird_dist_gap_y_index] = next_gap_y - bird_state.position_y;
 
-			bird_inputs[dist_to_ceiling_y] = game_config.ceiling_y -
+			bird_inputs[bird_dist_to_ceiling_y] = game_config.ceiling_y -
 				(bird_state.position_y + game_config.bird_radius);
 
-			bird_inputs[dist_to_floor_y] = (bird_state.position_y - game_config.bird_radius) - game_config.floor_y;
-
-			bird_inputs[bias_index] = 1.0f;
+			bird_inputs[bird_dist_to_floor_y] = (bird_state.position_y - game_config.bird_radius) -
+				game_config.floor_y;
 		}
 
 		for (const auto& inference_segment : inference_network_range.balanced_segments(thread_count)) {
 			threads.emplace_back([&, inference_segment]() {
-				neat::inference::evaluate_network_range(inference_networks, inputs, outputs, inference_segment);
+				flappy_trainer.place_inference_worker(inference_segment);
+				neat::inference::evaluate_network_range(
+					shared_input_networks,
+					shared_inputs,
+					inputs,
+					outputs,
+					inference_segment
+				);
 			});
 		}
 		for (auto& thread : threads) {
@@ -101,21 +137,43 @@ int main() {
 		threads.clear();
 
 		for (std::size_t i{}; i != game_state.active_bird_indices.size(); ++i) {
-			if (outputs[game_state.active_bird_indices[i]] > 0.5f) {
+			const auto output_index = game_state.active_bird_indices[i] * interface_config.output_count;
+			if (outputs[output_index] > 0.5f) {
 				game_engine.flap(i);
 			}
 		}
 	};
 
+	// Per generation trainer stats are only written if NEAT_TRAINER_STATS names a csv file.
+	auto trainer_stats_file = std::ofstream{};
+	if (const auto* const trainer_stats_path = std::getenv("NEAT_TRAINER_STATS")) {
+		trainer_stats_file.open(trainer_stats_path);
+		neat::write_csv_header(trainer_stats_file);
+	}
+
 	auto generation_index = std::size_t{};
 	while (not stop_training.test(std::memory_order_acquire)) {
 		std::cout << "|--------[ generation " << generation_index << " ]--------|" << std::endl;
 
-		flappy_trainer.evolve(fitness, inference_networks);
+		flappy_trainer.evolve(fitness.fitness(), inference_networks);
+		neat::inference::compile_shared_input_network_group(
+			inference_networks,
+			interface_config,
+			input_layout,
+			shared_input_networks
+		);
+
+		const auto& generation_stats = flappy_trainer.last_generation_stats();
+		if (trainer_stats_file.is_open()) {
+			neat::write_csv(trainer_stats_file, generation_stats);
+		}
+		std::cout << "Differentiated " << generation_stats.species_count << " species in "
+				  << std::chrono::duration_cast<std::chrono::milliseconds>(generation_stats.wall_time).count() << "ms"
+				  << std::endl;
 
 		std::cout << "Evaluating performance..." << std::endl;
 
-		std::fill(fitness.begin(), fitness.end(), 0.0f);
+		fitness.reset(population_size);
 
 		for (int i{}; i != game_batch_size; ++i) {
 			game_engine.reset();
@@ -126,23 +184,33 @@ int main() {
 
 			auto& game_state = game_engine.state();
 
-			for (std::size_t j{}; j != fitness.size(); ++j) {
+			for (neat::types::network_index_t j{}; j != population_size; ++j) {
 				const auto& bird_score = game_state.scores[j];
 				if (bird_score >= stop_score) {
 					stop_training.test_and_set(std::memory_order_acquire);
 					break;
 				}
-				fitness[j] += batch_scale * game_state.scores[j];
+				fitness.report(j, bird_score);
 			}
 		}
 
-		const auto [min_fitness_it, max_fitness_it] = std::minmax_element(fitness.begin(), fitness.end());
+		const auto [min_fitness_it, max_fitness_it] = std::minmax_element(
+			fitness.fitness().begin(),
+			fitness.fitness().end()
+		);
 		std::cout << "Average scores min: " << *min_fitness_it << " max: " << *max_fitness_it << std::endl;
 		++generation_index;
 	}
 
 	// keyboard_listener_thread.join();
 
+	// Export the trained networks if NEAT_EXPORT_NETWORKS names a file, so they can be mapped by a serving process.
+	if (const auto* const export_path = std::getenv("NEAT_EXPORT_NETWORKS")) {
+		if (const auto error = neat::inference::save_network_group(export_path, inference_networks, interface_config)) {
+			std::cerr << "Could not save networks: " << error.message() << std::endl;
+		}
+	}
+
 	//----------------------[ Window/GLEW Setup ]----------------------//
 
 	auto window = sf::RenderWindow(
@@ -226,8 +294,7 @@ void xor_test() {
 	const auto population_size = 1'000;
 	const auto thread_count = 1; // std::thread::hardware_concurrency();
 
-	neat::trainer xor_trainer(evolution_config, interface_config, population_size, thread_count);
-	neat::inference::types::network_group_t network_group;
+	neat::trainer xor_trainer(evolution_config, interface_config, population_size, thread_count, std::random_device{}());
 	std::array<float, 3> inputs;
 	std::array<float, 1> outputs;
 	debug_vector<neat::types::fitness_t> fitness(population_size, 0.0f);
@@ -240,10 +307,13 @@ void xor_test() {
 	const auto network_segments = integer_range<neat::types::network_index_t>::from_index_count(0, population_size);
 
 	while (true) {
-		xor_trainer.evolve(fitness, network_group);
+		xor_trainer.evolve_async(fitness);
 
+		// Every segment starts as soon as its networks are compiled.
 		for (const auto& network_segment : network_segments.balanced_segments(thread_count)) {
 			threads.emplace_back([&, network_segment]() {
+				xor_trainer.place_inference_worker(network_segment);
+				const auto& network_group = xor_trainer.wait_for_networks(network_segment);
 				for (const auto& [a, b] : { std::pair(false, false),
 				                            std::pair(false, true),
 				                            std::pair(true, false),
@@ -0,0 +1,96 @@
+#include "neat/fitness_accumulator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+
+namespace neat {
+
+fitness_accumulator::fitness_accumulator(const racing_config_t& racing_config) : m_racing_config{ racing_config } {
+}
+
+void fitness_accumulator::reset(const types::network_index_t network_count) {
+	m_fitness.assign(network_count, types::fitness_t{});
+	m_squared_deviations.assign(network_count, 0.0f);
+	m_episode_counts.assign(network_count, 0);
+	m_active.assign(network_count, true);
+
+	m_active_networks.resize(network_count);
+	std::iota(m_active_networks.begin(), m_active_networks.end(), types::network_index_t{});
+}
+
+void fitness_accumulator::report(const types::network_index_t network_index, const types::fitness_t episode_fitness) {
+	assert(network_index < m_fitness.size());
+
+	auto& mean = m_fitness[network_index];
+	const auto episode_count = ++m_episode_counts[network_index];
+
+	const auto deviation = episode_fitness - mean;
+	mean += deviation / static_cast<float>(episode_count);
+	m_squared_deviations[network_index] += deviation * (episode_fitness - mean);
+}
+
+types::network_index_t fitness_accumulator::update_racing() {
+	if (m_racing_config.policy == racing_policy_t::none or m_fitness.empty()) {
+		return m_active_networks.size();
+	}
+
+	const auto half_width = [&](const types::network_index_t network_index) {
+		const auto episode_count = m_episode_counts[network_index];
+		if (episode_count < std::max(m_racing_config.min_episode_count, 2u)) {
+			return std::numeric_limits<float>::infinity();
+		}
+		const auto variance = m_squared_deviations[network_index] / static_cast<float>(episode_count - 1);
+		return m_racing_config.confidence_width * std::sqrt(variance / static_cast<float>(episode_count));
+	};
+
+	// The lower bound of the elite network is the one the upper bounds of all other networks have to reach.
+	// Terminated networks keep their bounds, so they still count towards the elite.
+	m_lower_bounds.resize(m_fitness.size());
+	for (types::network_index_t i{}; i != m_fitness.size(); ++i) {
+		m_lower_bounds[i] = m_fitness[i] - half_width(i);
+	}
+
+	const auto elite_rank = std::min(
+		static_cast<std::size_t>(m_racing_config.elite_portion * static_cast<float>(m_fitness.size())),
+		m_fitness.size() - 1
+	);
+	std::nth_element(
+		m_lower_bounds.begin(),
+		m_lower_bounds.begin() + elite_rank,
+		m_lower_bounds.end(),
+		std::greater<float>{}
+	);
+	const auto elite_lower_bound = m_lower_bounds[elite_rank];
+
+	std::erase_if(m_active_networks, [&](const types::network_index_t network_index) {
+		const auto hopeless = m_fitness[network_index] + half_width(network_index) < elite_lower_bound;
+		if (hopeless) {
+			m_active[network_index] = false;
+		}
+		return hopeless;
+	});
+
+	return m_active_networks.size();
+}
+
+bool fitness_accumulator::is_active(const types::network_index_t network_index) const {
+	return m_active[network_index];
+}
+
+debug_span<const types::network_index_t> fitness_accumulator::active_networks() const {
+	return m_active_networks;
+}
+
+debug_span<const types::fitness_t> fitness_accumulator::fitness() const {
+	return m_fitness;
+}
+
+std::uint64_t fitness_accumulator::episode_count() const {
+	return std::accumulate(m_episode_counts.begin(), m_episode_counts.end(), std::uint64_t{});
+}
+
+} // namespace neat
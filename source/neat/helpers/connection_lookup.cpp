@@ -36,9 +36,7 @@ types::innovation_number_t connection_lookup::update_connection_info(
 
 	const auto node_pair = sorted_node_pair(from, to);
 
-	while (lock.test_and_set(std::memory_order_acquire)) {
-		// acquire lock
-	}
+	m_lock.lock();
 
 	auto [index, found] = lookup_connection(node_pair);
 
@@ -50,7 +48,7 @@ types::innovation_number_t connection_lookup::update_connection_info(
 		m_node_pairs.insert(m_node_pairs.begin() + index, node_pair);
 	}
 
-	lock.clear(std::memory_order_release);
+	m_lock.unlock();
 
 	innovation_numbers[conn_index].enabled = true;
 	innovation_numbers[conn_index].innovation_number = inno_num;
@@ -58,4 +56,12 @@ types::innovation_number_t connection_lookup::update_connection_info(
 	return inno_num;
 }
 
+spin_lock_stats_t connection_lookup::lock_stats() const {
+	return m_lock.stats();
+}
+
+void connection_lookup::reset_lock_stats() {
+	m_lock.reset_stats();
+}
+
 } // namespace neat
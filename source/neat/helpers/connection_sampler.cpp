@@ -0,0 +1,147 @@
+#include "neat/helpers/connection_sampler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <numeric>
+
+namespace neat {
+
+void connection_sampler::assign(
+	const network_interface_config_t& interface_config,
+	const types::node_index_t hidden_node_count,
+	debug_span<const types::connection_t> connections,
+	const bool allow_loops
+) {
+	m_input_count = interface_config.input_count;
+	m_output_count = interface_config.output_count;
+	m_node_count = m_input_count + m_output_count + hidden_node_count;
+	m_words_per_row = (m_node_count + word_bit_count - 1) / word_bit_count;
+
+	m_rows.assign(m_node_count * m_words_per_row, 0);
+
+	const auto set_bit = [](debug_span<word_t> row, const types::node_index_t node) {
+		row[node / word_bit_count] |= word_t{ 1 } << (node % word_bit_count);
+	};
+
+	// Predecessors only need to be excluded if they would close a loop.
+	if (not allow_loops) {
+		// Once the connections are sorted by the rank of their destination, the predecessors of every source
+		// are complete before they get passed on. The ranks are a permutation of the node indices,
+		// so a counting sort is enough.
+		m_order.assign(m_node_count, connections);
+
+		m_rank_offsets.assign(m_node_count + 1, 0);
+		for (const auto& connection : connections) {
+			++m_rank_offsets[m_order.rank(connection.to) + 1];
+		}
+		std::partial_sum(m_rank_offsets.begin(), m_rank_offsets.end(), m_rank_offsets.begin());
+
+		m_rank_sorted_connections.resize(connections.size());
+		for (const auto& connection : connections) {
+			m_rank_sorted_connections[m_rank_offsets[m_order.rank(connection.to)]++] = connection;
+		}
+
+		for (const auto& [from, to] : m_rank_sorted_connections) {
+			const auto from_row = row(m_rows, from);
+			const auto to_row = row(m_rows, to);
+			for (types::node_index_t i{}; i != m_words_per_row; ++i) {
+				to_row[i] |= from_row[i];
+			}
+			set_bit(to_row, from);
+		}
+	}
+
+	// Existing connections are excluded only after all predecessors were passed on.
+	for (const auto& [from, to] : connections) {
+		set_bit(row(m_rows, from), to);
+	}
+
+	// Output nodes can't be sources, so only inputs and hidden nodes get a row of destinations.
+	m_source_nodes.clear();
+	for (types::node_index_t node{}; node != m_node_count; ++node) {
+		if (node < m_input_count or node >= m_input_count + m_output_count) {
+			m_source_nodes.push_back(node);
+		}
+	}
+
+	m_candidate_count_prefixes.resize(m_source_nodes.size());
+
+	auto candidate_count = std::size_t{};
+	for (std::size_t i{}; i != m_source_nodes.size(); ++i) {
+		const auto source = m_source_nodes[i];
+		const auto source_row = row(m_rows, source);
+
+		set_bit(source_row, source);
+
+		// Inputs can't be destinations, so only the bits from input_count up to node_count are valid.
+		for (types::node_index_t word_index{}; word_index != m_words_per_row; ++word_index) {
+			const auto word_begin = word_index * word_bit_count;
+			const auto valid_begin = std::clamp(m_input_count, word_begin, word_begin + word_bit_count) - word_begin;
+			const auto valid_end = std::clamp(m_node_count, word_begin, word_begin + word_bit_count) - word_begin;
+
+			auto valid_mask = word_t{};
+			if (valid_begin != valid_end) {
+				valid_mask = ~word_t{} >> (word_bit_count - (valid_end - valid_begin)) << valid_begin;
+			}
+
+			auto& word = source_row[word_index];
+			word = ~word & valid_mask;
+			candidate_count += static_cast<std::size_t>(std::popcount(word));
+		}
+
+		m_candidate_count_prefixes[i] = candidate_count;
+	}
+}
+
+std::size_t connection_sampler::candidate_count() const {
+	return m_candidate_count_prefixes.empty() ? 0 : m_candidate_count_prefixes.back();
+}
+
+types::connection_t connection_sampler::candidate(std::size_t index) const {
+	assert(index < candidate_count());
+
+	const auto prefix_it = std::upper_bound(
+		m_candidate_count_prefixes.begin(),
+		m_candidate_count_prefixes.end(),
+		index
+	);
+	const auto source_index = static_cast<std::size_t>(prefix_it - m_candidate_count_prefixes.begin());
+	if (source_index != 0) {
+		index -= m_candidate_count_prefixes[source_index - 1];
+	}
+
+	const auto source = m_source_nodes[source_index];
+	const auto source_row = row(m_rows, source);
+
+	for (types::node_index_t word_index{}; word_index != m_words_per_row; ++word_index) {
+		auto word = source_row[word_index];
+		const auto word_candidate_count = static_cast<std::size_t>(std::popcount(word));
+		if (index >= word_candidate_count) {
+			index -= word_candidate_count;
+			continue;
+		}
+		while (index--) {
+			word &= word - 1;
+		}
+		return { .from = source,
+			     .to = word_index * word_bit_count + static_cast<types::node_index_t>(std::countr_zero(word)) };
+	}
+
+	assert(false and "candidate count prefixes don't match the rows");
+	return { .from = invalid_node_index, .to = invalid_node_index };
+}
+
+debug_span<connection_sampler::word_t> connection_sampler::row(
+	debug_vector<word_t>& rows, const types::node_index_t node
+) const {
+	return { rows.begin() + node * m_words_per_row, m_words_per_row };
+}
+
+debug_span<const connection_sampler::word_t> connection_sampler::row(
+	const debug_vector<word_t>& rows, const types::node_index_t node
+) const {
+	return { rows.begin() + node * m_words_per_row, m_words_per_row };
+}
+
+} // namespace neat
@@ -0,0 +1,275 @@
+#include "neat/helpers/numa_topology.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <ranges>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace neat {
+
+// Parses cpu lists in the sysfs format, for example "0-3,8,10-11".
+static debug_vector<std::uint32_t> parse_cpu_list(const std::string_view text) {
+	debug_vector<std::uint32_t> cpus;
+
+	auto it = text.data();
+	const auto end = text.data() + text.size();
+	while (it != end) {
+		auto first = std::uint32_t{};
+		auto [first_end, first_error] = std::from_chars(it, end, first);
+		if (first_error != std::errc{}) {
+			break;
+		}
+		auto last = first;
+		if (first_end != end and *first_end == '-') {
+			const auto [last_end, last_error] = std::from_chars(first_end + 1, end, last);
+			if (last_error != std::errc{}) {
+				break;
+			}
+			first_end = last_end;
+		}
+		for (auto cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+		it = first_end == end ? end : first_end + 1;
+	}
+
+	return cpus;
+}
+
+static debug_vector<std::uint32_t> usable_cpus() {
+	debug_vector<std::uint32_t> cpus;
+
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+		for (std::uint32_t cpu{}; cpu != CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &cpu_set)) {
+				cpus.push_back(cpu);
+			}
+		}
+	}
+#endif
+
+	if (cpus.empty()) {
+		cpus.resize(std::max(std::thread::hardware_concurrency(), 1u));
+		for (std::uint32_t cpu{}; cpu != cpus.size(); ++cpu) {
+			cpus[cpu] = cpu;
+		}
+	}
+
+	return cpus;
+}
+
+numa_topology numa_topology::detect() {
+	const auto cpus = usable_cpus();
+
+	numa_topology topology;
+	topology.m_nodes.clear();
+
+	// Node numbers can have gaps, but the kernel rarely uses more than a few.
+	static constexpr auto max_node_number = 1024u;
+	for (std::uint32_t node_number{}; node_number != max_node_number; ++node_number) {
+		auto file = std::ifstream("/sys/devices/system/node/node" + std::to_string(node_number) + "/cpulist");
+		if (not file) {
+			continue;
+		}
+		auto text = std::string{};
+		std::getline(file, text);
+
+		auto node_cpus = parse_cpu_list(text);
+		std::erase_if(node_cpus, [&](const std::uint32_t cpu) {
+			return std::find(cpus.begin(), cpus.end(), cpu) == cpus.end();
+		});
+
+		// Memory only nodes and nodes outside of the affinity mask can't run workers.
+		if (not node_cpus.empty()) {
+			topology.m_nodes.push_back({ .cpus = std::move(node_cpus) });
+		}
+	}
+
+	if (topology.m_nodes.empty()) {
+		topology.m_nodes.push_back({ .cpus = cpus });
+	}
+
+	return topology;
+}
+
+numa_topology numa_topology::fake(const std::uint32_t node_count) {
+	const auto cpus = usable_cpus();
+
+	numa_topology topology;
+	topology.m_nodes.resize(std::max(node_count, 1u));
+
+	const auto cpu_count = cpus.size();
+	const auto fake_node_count = topology.m_nodes.size();
+	for (std::size_t node{}; node != fake_node_count; ++node) {
+		auto& node_cpus = topology.m_nodes[node].cpus;
+		node_cpus.assign(
+			cpus.begin() + static_cast<std::ptrdiff_t>(node * cpu_count / fake_node_count),
+			cpus.begin() + static_cast<std::ptrdiff_t>((node + 1) * cpu_count / fake_node_count)
+		);
+		if (node_cpus.empty()) {
+			node_cpus.push_back(cpus[node % cpu_count]);
+		}
+	}
+
+	return topology;
+}
+
+// The first logical CPU of the core, all SMT siblings of a core map to the same CPU.
+static std::uint32_t core_of_cpu(const std::uint32_t cpu) {
+	auto file = std::ifstream(
+		"/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list"
+	);
+	auto text = std::string{};
+	std::getline(file, text);
+
+	const auto siblings = parse_cpu_list(text);
+	return siblings.empty() ? cpu : *std::min_element(siblings.begin(), siblings.end());
+}
+
+void numa_topology::restrict_worker_cpus(const bool avoid_smt_siblings, std::uint32_t reserved_core_count) {
+	for (auto& node : m_nodes | std::views::reverse) {
+		debug_vector<std::uint32_t> cores;
+		for (const auto& cpu : node.cpus) {
+			const auto core = core_of_cpu(cpu);
+			if (std::find(cores.begin(), cores.end(), core) == cores.end()) {
+				cores.push_back(core);
+			}
+		}
+
+		while (reserved_core_count != 0 and cores.size() > 1) {
+			cores.pop_back();
+			--reserved_core_count;
+		}
+
+		// The first usable sibling represents its core, the lowest one might be outside of the affinity mask.
+		debug_vector<std::uint32_t> kept_cores;
+		std::erase_if(node.cpus, [&](const std::uint32_t cpu) {
+			const auto core = core_of_cpu(cpu);
+			if (std::find(cores.begin(), cores.end(), core) == cores.end()) {
+				return true;
+			}
+			if (not avoid_smt_siblings) {
+				return false;
+			}
+			if (std::find(kept_cores.begin(), kept_cores.end(), core) != kept_cores.end()) {
+				return true;
+			}
+			kept_cores.push_back(core);
+			return false;
+		});
+	}
+}
+
+std::uint32_t numa_topology::node_count() const {
+	return static_cast<std::uint32_t>(m_nodes.size());
+}
+
+debug_span<const std::uint32_t> numa_topology::cpus(const std::uint32_t node) const {
+	return m_nodes[node].cpus;
+}
+
+std::uint32_t numa_topology::partition_node(const std::size_t index, const std::size_t size) const {
+	if (size == 0) {
+		return 0;
+	}
+	return static_cast<std::uint32_t>(std::min(index, size - 1) * m_nodes.size() / size);
+}
+
+bool numa_topology::pin_current_thread(const std::uint32_t node) const {
+	return pin_current_thread_to(m_nodes[node].cpus);
+}
+
+bool numa_topology::pin_current_thread(const std::size_t index, const std::size_t size) const {
+	const auto node = partition_node(index, size);
+	const auto& node_cpus = m_nodes[node].cpus;
+	if (node_cpus.empty()) {
+		return false;
+	}
+
+	// The position of the element in the part owned by the node, scaled by the node count.
+	const auto node_position = std::min(index, size - 1) * m_nodes.size() - node * size;
+	const auto cpu_index = node_position * node_cpus.size() / size;
+	return pin_current_thread_to(debug_span(node_cpus.data() + cpu_index, 1));
+}
+
+int numa_topology::current_cpu() {
+#ifdef __linux__
+	return sched_getcpu();
+#else
+	return -1;
+#endif
+}
+
+bool numa_topology::pin_current_thread_to(debug_span<const std::uint32_t> cpus) {
+	if (cpus.empty()) {
+		return false;
+	}
+
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (const auto& cpu : cpus) {
+		CPU_SET(cpu, &cpu_set);
+	}
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+	return false;
+#endif
+}
+
+void numa_topology::first_touch(void* const data, const std::size_t byte_count, const std::size_t page_size) const {
+#ifdef __linux__
+	const auto address = reinterpret_cast<std::uintptr_t>(data);
+	const auto pages_begin = (address + page_size - 1) / page_size * page_size;
+	const auto pages_end = (address + byte_count) / page_size * page_size;
+	if (pages_begin >= pages_end) {
+		return;
+	}
+
+	const auto page_count = (pages_end - pages_begin) / page_size;
+
+	// Hugepages may be backed by smaller pages, so every system page is touched.
+	const auto system_page_size = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+
+	// Fresh memory has no pages yet. Explicit hugepage mappings can't always be released, but they are only ever
+	// first touched while fresh, so a failure is ignored.
+	static_cast<void>(madvise(reinterpret_cast<void*>(pages_begin), pages_end - pages_begin, MADV_DONTNEED));
+
+	debug_vector<std::thread> threads;
+	threads.reserve(m_nodes.size());
+
+	for (std::uint32_t node{}; node != m_nodes.size(); ++node) {
+		threads.emplace_back([&, node]() {
+			pin_current_thread(node);
+			const auto partition_begin = pages_begin + node * page_count / m_nodes.size() * page_size;
+			const auto partition_end = pages_begin + (node + 1) * page_count / m_nodes.size() * page_size;
+			for (auto page = partition_begin; page < partition_end; page += system_page_size) {
+				*reinterpret_cast<volatile std::byte*>(page) = std::byte{};
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+#else
+	static_cast<void>(data);
+	static_cast<void>(byte_count);
+	static_cast<void>(page_size);
+#endif
+}
+
+} // namespace neat
@@ -0,0 +1,74 @@
+#include "neat/helpers/phase_recorder.hpp"
+
+#include <algorithm>
+
+namespace neat {
+
+void phase_recorder::begin_generation() {
+	for (auto& phase_stats : m_stats.phases) {
+		// Keep the worker vector's capacity.
+		phase_stats.wall_time = {};
+		phase_stats.worker_busy_times.clear();
+		phase_stats.item_count = 0;
+		phase_stats.bytes_touched = 0;
+		phase_stats.migrated_worker_count = 0;
+	}
+	m_stats.generation_index = m_generation_count++;
+	m_stats.wall_time = {};
+	m_serial_time = {};
+
+	std::fill(
+		m_phase_bounds.begin(),
+		m_phase_bounds.end(),
+		std::pair{ clock_t::time_point::max(), clock_t::time_point::min() }
+	);
+	m_generation_begin = clock_t::now();
+}
+
+void phase_recorder::end_generation() {
+	m_stats.wall_time = clock_t::now() - m_generation_begin;
+
+	for (std::size_t i{}; i != trainer_phase_count; ++i) {
+		const auto& [begin, end] = m_phase_bounds[i];
+		m_stats.phases[i].wall_time = begin < end ? end - begin : std::chrono::nanoseconds{};
+	}
+	m_stats.phase(trainer_phase_t::serial).wall_time = m_serial_time;
+}
+
+void phase_recorder::record(
+	const trainer_phase_t phase, const clock_t::time_point begin, const clock_t::time_point end
+) {
+	const auto phase_index = static_cast<std::size_t>(phase);
+
+	const auto lock = std::scoped_lock(m_mutex);
+
+	auto& [phase_begin, phase_end] = m_phase_bounds[phase_index];
+	phase_begin = std::min(phase_begin, begin);
+	phase_end = std::max(phase_end, end);
+
+	m_stats.phases[phase_index].worker_busy_times.push_back(end - begin);
+}
+
+void phase_recorder::record_serial(const clock_t::time_point begin, const clock_t::time_point end) {
+	const auto lock = std::scoped_lock(m_mutex);
+	m_serial_time += end - begin;
+}
+
+void phase_recorder::worker_placed() {
+	s_worker_cpu = numa_topology::current_cpu();
+}
+
+void phase_recorder::record_migration(const trainer_phase_t phase) {
+	const auto lock = std::scoped_lock(m_mutex);
+	++m_stats.phases[static_cast<std::size_t>(phase)].migrated_worker_count;
+}
+
+generation_stats_t& phase_recorder::stats() {
+	return m_stats;
+}
+
+const generation_stats_t& phase_recorder::stats() const {
+	return m_stats;
+}
+
+} // namespace neat
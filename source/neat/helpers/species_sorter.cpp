@@ -1,13 +1,78 @@
 #include "neat/helpers/species_sorter.hpp"
 
 #include <algorithm>
-#include <iostream> // TODO remove
 
 namespace neat {
 
-void species_sorter::clear() {
+types::network_index_t species_sorter::clear(const types::network_index_t network_count) {
 	m_characteristic_networks.clear();
-	m_species_buckets.clear();
+	m_lookup_lock.reset_stats();
+
+	const auto chunk_count = (network_count + candidate_chunk_size - 1) / candidate_chunk_size;
+	m_chunk_candidates.resize(chunk_count);
+	for (auto& candidates : m_chunk_candidates) {
+		candidates.clear();
+	}
+	m_picked_representative_count = 0;
+	m_unmatched_networks.clear();
+
+	return chunk_count;
+}
+
+void species_sorter::find_candidates(
+	const difference_config_t& config,
+	debug_span<const types::connection_weight_t> connection_weights,
+	debug_span<const types::connection_info_t> connection_infos,
+	debug_span<const types::network_t> networks,
+	const types::network_index_t chunk_index
+) {
+	auto& candidates = m_chunk_candidates[chunk_index];
+
+	const auto chunk_begin = chunk_index * candidate_chunk_size;
+	const auto chunk = types::network_range_t::from_begin_end(
+		chunk_begin,
+		std::min(chunk_begin + candidate_chunk_size, static_cast<types::network_index_t>(networks.size()))
+	);
+
+	for (const auto& network_index : chunk.indices()) {
+		const auto& network = networks[network_index];
+		const auto matches_candidate = std::any_of(
+			candidates.begin(),
+			candidates.end(),
+			[&](const auto& candidate_index) {
+				return network_difference(
+					config,
+					connection_weights,
+					connection_infos,
+					network,
+					networks[candidate_index]
+				) < config.difference_threshold;
+			}
+		);
+		if (not matches_candidate) {
+			candidates.push_back(network_index);
+		}
+	}
+}
+
+void species_sorter::pick_representatives(
+	const difference_config_t& config,
+	debug_span<const types::connection_weight_t> connection_weights,
+	debug_span<const types::connection_info_t> connection_infos,
+	debug_span<const types::network_t> networks,
+	const types::network_index_t& approx_bucket_size
+) {
+	for (const auto& candidates : m_chunk_candidates) {
+		for (const auto& candidate_index : candidates) {
+			const auto& candidate = networks[candidate_index];
+			const auto known_species = types::species_range_t::from_index_count(0, m_characteristic_networks.size());
+			if (search_matching_network(config, connection_weights, connection_infos, candidate, known_species) ==
+			    invalid_species_index) {
+				add_representative(candidate, approx_bucket_size);
+			}
+		}
+	}
+	m_picked_representative_count = m_characteristic_networks.size();
 }
 
 void species_sorter::sort_into_buckets(
@@ -15,79 +80,100 @@ void species_sorter::sort_into_buckets(
 	debug_span<const types::connection_weight_t> connection_weights,
 	debug_span<const types::connection_info_t> connection_infos,
 	debug_span<const types::network_t> networks,
-	const types::network_index_t& approx_bucket_size,
 	const types::network_range_t& network_range
 ) {
-	for (const auto& network : network_range.span(networks)) {
+	const auto picked_species = types::species_range_t::from_index_count(0, m_picked_representative_count);
 
-		while (m_lookup_lock.test_and_set(std::memory_order_acquire)) {
-			// acquire lookup lock
-		}
-		const auto known_species = types::species_range_t::from_index_count(0, m_characteristic_networks.size());
-		m_lookup_lock.clear(std::memory_order_release);
+	for (const auto& network_index : network_range.indices()) {
+		const auto& network = networks[network_index];
 
-		auto matching_index = search_matching_network(
+		const auto matching_index = search_matching_network(
 			config,
 			connection_weights,
 			connection_infos,
 			network,
-			known_species
+			picked_species
 		);
 
-		// TODO Some kind of deadlock I guess
-
 		if (matching_index == invalid_species_index) {
-			while (m_lookup_lock.test_and_set(std::memory_order_acquire)) {
-				// re-acquire lookup lock
-			}
-			const auto unchecked_entries = types::species_range_t::from_begin_end(
-				known_species.end(),
-				m_characteristic_networks.size()
-			);
-			matching_index = search_matching_network(
-				config,
-				connection_weights,
-				connection_infos,
-				network,
-				unchecked_entries
-			);
-			if (matching_index == invalid_species_index) {
-				matching_index = m_characteristic_networks.size();
-				m_characteristic_networks.push_back(network);
-				auto& new_bucket = m_species_buckets.emplace_back();
-				new_bucket.networks.reserve(approx_bucket_size);
-			}
-			m_lookup_lock.clear(std::memory_order_release);
+			m_lookup_lock.lock();
+			m_unmatched_networks.push_back(network_index);
+			m_lookup_lock.unlock();
+			continue;
 		}
 
 		auto& bucket = m_species_buckets[matching_index];
-		while (bucket.lock.test_and_set(std::memory_order_acquire)) {
-			// acquire bucket lock
-		}
-		bucket.networks.push_back(network);
-		bucket.lock.clear(std::memory_order_release);
+		bucket.lock.lock();
+		bucket.networks.emplace_back(network_index, network);
+		bucket.lock.unlock();
 	}
 }
 
 void species_sorter::assign_species_and_sorted_networks(
-	debug_vector<types::species_t>& all_species, debug_span<types::network_t> networks
+	const difference_config_t& config,
+	debug_span<const types::connection_weight_t> connection_weights,
+	debug_span<const types::connection_info_t> connection_infos,
+	debug_vector<types::species_t>& all_species,
+	debug_span<types::network_t> networks
 ) {
+	// Only the representatives added for earlier unmatched networks can match, the picked ones were checked already.
+	std::sort(m_unmatched_networks.begin(), m_unmatched_networks.end());
+	for (const auto& network_index : m_unmatched_networks) {
+		const auto& network = networks[network_index];
+		const auto added_species = types::species_range_t::from_begin_end(
+			m_picked_representative_count,
+			m_characteristic_networks.size()
+		);
+		auto matching_index = search_matching_network(
+			config,
+			connection_weights,
+			connection_infos,
+			network,
+			added_species
+		);
+		if (matching_index == invalid_species_index) {
+			matching_index = m_characteristic_networks.size();
+			add_representative(network, 1);
+		}
+		m_species_buckets[matching_index].networks.emplace_back(network_index, network);
+	}
+
 	all_species.resize(m_characteristic_networks.size());
-	std::cout << "Differentiated " << all_species.size() << " species\n";
 
 	auto network_index = types::species_index_t{};
 
-	for (types::species_index_t i = 0; i != m_species_buckets.size(); ++i) {
-		const auto& species_bucket = m_species_buckets[i];
+	for (types::species_index_t i = 0; i != m_characteristic_networks.size(); ++i) {
+		auto& species_bucket = m_species_buckets[i];
 
-		std::copy(species_bucket.networks.begin(), species_bucket.networks.end(), networks.begin() + network_index);
+		std::sort(
+			species_bucket.networks.begin(),
+			species_bucket.networks.end(),
+			[](const auto& a, const auto& b) { return a.first < b.first; }
+		);
+		std::transform(
+			species_bucket.networks.begin(),
+			species_bucket.networks.end(),
+			networks.begin() + network_index,
+			[](const auto& indexed_network) { return indexed_network.second; }
+		);
 
 		auto& species = all_species[i];
 		species.networks = types::species_range_t::from_index_count(network_index, species_bucket.networks.size());
 
 		network_index = species.networks.end();
 	}
-	std::cout << "Networks sorted into species.\n";
+}
+
+spin_lock_stats_t species_sorter::lookup_lock_stats() const {
+	return m_lookup_lock.stats();
+}
+
+spin_lock_stats_t species_sorter::bucket_lock_stats() const {
+	auto stats = spin_lock_stats_t{};
+	for (types::species_index_t i = 0; i != m_characteristic_networks.size(); ++i) {
+		stats += m_species_buckets[i].lock.stats();
+	}
+	return stats;
 }
 
 types::species_index_t species_sorter::search_matching_network(
@@ -96,7 +182,7 @@ types::species_index_t species_sorter::search_matching_network(
 	debug_span<const types::connection_info_t> connection_infos,
 	const types::network_t& network,
 	const types::network_range_t& lookup_range
-) {
+) const {
 	for (const auto& entry_index : lookup_range.indices()) {
 		auto& characteristic_network = m_characteristic_networks[entry_index];
 		if (network_difference(config, connection_weights, connection_infos, network, characteristic_network) <
@@ -107,6 +193,19 @@ types::species_index_t species_sorter::search_matching_network(
 	return invalid_species_index;
 }
 
+void species_sorter::add_representative(
+	const types::network_t& network, const types::network_index_t approx_bucket_size
+) {
+	if (m_species_buckets.size() == m_characteristic_networks.size()) {
+		m_species_buckets.emplace_back();
+	}
+	auto& new_bucket = m_species_buckets[m_characteristic_networks.size()];
+	new_bucket.lock.reset_stats();
+	new_bucket.networks.clear();
+	new_bucket.networks.reserve(approx_bucket_size);
+	m_characteristic_networks.push_back(network);
+}
+
 float species_sorter::network_difference(
 	const difference_config_t& config,
 	debug_span<const types::connection_weight_t> connection_weights,
@@ -0,0 +1,198 @@
+#include "neat/helpers/topological_order.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace neat {
+
+void topological_order::reset(const types::node_index_t node_count) {
+	m_ranks.resize(node_count);
+	std::iota(m_ranks.begin(), m_ranks.end(), types::node_index_t{});
+
+	m_first_outgoing.assign(node_count, invalid_conn_index);
+	m_first_incoming.assign(node_count, invalid_conn_index);
+	m_edges.clear();
+
+	m_visited.assign(node_count, false);
+}
+
+void topological_order::assign(
+	const types::node_index_t node_count, debug_span<const types::connection_t> connections
+) {
+	reset(node_count);
+
+	for (const auto& [from, to] : connections) {
+		add_edge(from, to);
+	}
+
+	// Kahn's algorithm, the affected ranks buffer is borrowed to count the unranked incoming connections.
+	auto& incoming_counts = m_affected_ranks;
+	incoming_counts.assign(node_count, 0);
+	for (const auto& edge : m_edges) {
+		++incoming_counts[edge.to];
+	}
+
+	m_node_stack.clear();
+	for (types::node_index_t node{}; node != node_count; ++node) {
+		if (incoming_counts[node] == 0) {
+			m_node_stack.push_back(node);
+		}
+	}
+
+	types::node_index_t next_rank{};
+	while (not m_node_stack.empty()) {
+		const auto node = m_node_stack.back();
+		m_node_stack.pop_back();
+
+		m_ranks[node] = next_rank++;
+
+		for (auto edge_index = m_first_outgoing[node]; edge_index != invalid_conn_index;
+		     edge_index = m_edges[edge_index].next_outgoing) {
+			if (--incoming_counts[m_edges[edge_index].to] == 0) {
+				m_node_stack.push_back(m_edges[edge_index].to);
+			}
+		}
+	}
+
+	assert(next_rank == node_count and "topological_order assigned network that contains a loop");
+}
+
+bool topological_order::would_create_loop(const types::node_index_t from, const types::node_index_t to) {
+	if (from == to) {
+		return true;
+	}
+	if (m_ranks[from] < m_ranks[to]) {
+		return false;
+	}
+
+	const auto creates_loop = search_forward(from, to);
+	clear_visited();
+
+	return creates_loop;
+}
+
+bool topological_order::try_add_connection(const types::node_index_t from, const types::node_index_t to) {
+	if (from == to) {
+		return false;
+	}
+
+	if (m_ranks[from] > m_ranks[to]) {
+		const auto creates_loop = search_forward(from, to);
+		if (not creates_loop) {
+			search_backward(from, to);
+			reorder();
+		}
+		clear_visited();
+
+		if (creates_loop) {
+			return false;
+		}
+	}
+
+	add_edge(from, to);
+
+	return true;
+}
+
+types::node_index_t topological_order::rank(const types::node_index_t node) const {
+	return m_ranks[node];
+}
+
+void topological_order::add_edge(const types::node_index_t from, const types::node_index_t to) {
+	assert(from < m_ranks.size() and to < m_ranks.size());
+
+	const auto edge_index = m_edges.size();
+	m_edges.push_back({ .from = from,
+	                    .to = to,
+	                    .next_outgoing = m_first_outgoing[from],
+	                    .next_incoming = m_first_incoming[to] });
+	m_first_outgoing[from] = edge_index;
+	m_first_incoming[to] = edge_index;
+}
+
+bool topological_order::search_forward(const types::node_index_t from, const types::node_index_t to) {
+	m_forward_nodes.clear();
+	m_backward_nodes.clear();
+
+	// A loop can only be closed by nodes ranked between 'to' and 'from'.
+	const auto upper_rank = m_ranks[from];
+
+	m_visited[to] = true;
+	m_forward_nodes.push_back(to);
+	m_node_stack.assign(1, to);
+
+	while (not m_node_stack.empty()) {
+		const auto node = m_node_stack.back();
+		m_node_stack.pop_back();
+
+		for (auto edge_index = m_first_outgoing[node]; edge_index != invalid_conn_index;
+		     edge_index = m_edges[edge_index].next_outgoing) {
+			const auto next_node = m_edges[edge_index].to;
+			if (next_node == from) {
+				return true;
+			}
+			if (not m_visited[next_node] and m_ranks[next_node] < upper_rank) {
+				m_visited[next_node] = true;
+				m_forward_nodes.push_back(next_node);
+				m_node_stack.push_back(next_node);
+			}
+		}
+	}
+
+	return false;
+}
+
+void topological_order::search_backward(const types::node_index_t from, const types::node_index_t to) {
+	const auto lower_rank = m_ranks[to];
+
+	m_visited[from] = true;
+	m_backward_nodes.push_back(from);
+	m_node_stack.assign(1, from);
+
+	while (not m_node_stack.empty()) {
+		const auto node = m_node_stack.back();
+		m_node_stack.pop_back();
+
+		for (auto edge_index = m_first_incoming[node]; edge_index != invalid_conn_index;
+		     edge_index = m_edges[edge_index].next_incoming) {
+			const auto prev_node = m_edges[edge_index].from;
+			if (not m_visited[prev_node] and m_ranks[prev_node] > lower_rank) {
+				m_visited[prev_node] = true;
+				m_backward_nodes.push_back(prev_node);
+				m_node_stack.push_back(prev_node);
+			}
+		}
+	}
+}
+
+void topological_order::reorder() {
+	const auto by_rank = [&](const auto& a, const auto& b) { return m_ranks[a] < m_ranks[b]; };
+	std::sort(m_backward_nodes.begin(), m_backward_nodes.end(), by_rank);
+	std::sort(m_forward_nodes.begin(), m_forward_nodes.end(), by_rank);
+
+	m_affected_ranks.clear();
+	for (const auto& nodes : { &m_backward_nodes, &m_forward_nodes }) {
+		for (const auto& node : *nodes) {
+			m_affected_ranks.push_back(m_ranks[node]);
+		}
+	}
+	std::sort(m_affected_ranks.begin(), m_affected_ranks.end());
+
+	auto rank_it = m_affected_ranks.begin();
+	for (const auto& nodes : { &m_backward_nodes, &m_forward_nodes }) {
+		for (const auto& node : *nodes) {
+			m_ranks[node] = *rank_it++;
+		}
+	}
+}
+
+void topological_order::clear_visited() {
+	for (const auto& nodes : { &m_forward_nodes, &m_backward_nodes }) {
+		for (const auto& node : *nodes) {
+			m_visited[node] = false;
+		}
+	}
+}
+
+} // namespace neat
@@ -0,0 +1,118 @@
+#include "neat/helpers/weight_mutation.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+namespace neat {
+
+static constexpr auto lane_count = std::size_t{ 32 };
+static constexpr auto words_per_block = std::tuple_size_v<philox_rng::counter_t>;
+static constexpr auto lane_block_count = lane_count / words_per_block;
+
+using lanes_t = std::array<float, lane_count>;
+
+// Every variate of a weight comes from its own random word, of which the top 24 bits are used, as that is all a float
+// mantissa can represent. Gaussian perturbations need two words, one for the radius and one for the angle.
+enum class variate_t : std::uint32_t { selection, replacement, perturbation, angle };
+
+template<weight_perturbation_t Perturbation>
+static void mutate_lanes(
+	const weight_distribution_config_t& config,
+	const float perturbation_rate,
+	const weight_mutation_stream_t& stream,
+	const std::size_t chunk_index,
+	lanes_t& weights
+) {
+	static constexpr auto variate_count = std::size_t{ Perturbation == weight_perturbation_t::gaussian ? 4 : 3 };
+	static constexpr auto unit_scale = 1.0f / static_cast<float>(1u << 24);
+
+	// All variates are generated in one go, so the rounds run on as many lanes as possible.
+	std::array<philox_rng::counter_t, variate_count * lane_block_count> counters;
+	for (std::size_t i{}; i != counters.size(); ++i) {
+		counters[i] = { static_cast<std::uint32_t>(chunk_index * lane_block_count + i % lane_block_count),
+			            stream.generation,
+			            static_cast<std::uint32_t>(i / lane_block_count),
+			            stream.purpose };
+	}
+
+	const auto words = philox_rng::blocks(stream.key, counters);
+
+	// Word i of block j belongs to lane i * lane_block_count + j, which keeps all loops below contiguous.
+	const auto gather_units = [&words](const variate_t variate, lanes_t& units) {
+		const auto offset = static_cast<std::size_t>(variate) * lane_block_count;
+		for (std::size_t i{}; i != words_per_block; ++i) {
+			for (std::size_t j{}; j != lane_block_count; ++j) {
+				units[i * lane_block_count + j] = static_cast<float>(words[i][offset + j] >> 8) * unit_scale;
+			}
+		}
+	};
+
+	lanes_t selection, replacement, perturbation;
+	gather_units(variate_t::selection, selection);
+	gather_units(variate_t::replacement, replacement);
+	gather_units(variate_t::perturbation, perturbation);
+
+	if constexpr (Perturbation == weight_perturbation_t::gaussian) {
+		lanes_t angle;
+		gather_units(variate_t::angle, angle);
+		// Box-Muller transform, 1 - u keeps the logarithm finite.
+		for (std::size_t i{}; i != lane_count; ++i) {
+			perturbation[i] = config.conn_weight_offset_stddev * std::sqrt(-2.0f * std::log(1.0f - perturbation[i])) *
+				std::cos(2.0f * std::numbers::pi_v<float> * angle[i]);
+		}
+	} else {
+		// std::lerp handles edge cases with branches, which prevents vectorization.
+		const auto offset_min = config.conn_weight_offset_min;
+		const auto offset_range = config.conn_weight_offset_max - config.conn_weight_offset_min;
+		for (std::size_t i{}; i != lane_count; ++i) {
+			perturbation[i] = offset_min + offset_range * perturbation[i];
+		}
+	}
+
+	const auto weight_range = config.conn_weight_max - config.conn_weight_min;
+	for (std::size_t i{}; i != lane_count; ++i) {
+		const auto replaced = config.conn_weight_min + weight_range * replacement[i];
+		weights[i] = selection[i] < perturbation_rate ? weights[i] + perturbation[i] : replaced;
+	}
+}
+
+void mutate_weights(
+	const weight_distribution_config_t& distribution_config,
+	const float perturbation_rate,
+	const weight_mutation_stream_t& stream,
+	const types::conn_index_t first_conn_index,
+	debug_span<types::connection_weight_t> weights
+) {
+	// Chunks are aligned to absolute connection indices, so partial chunks only occur at the span's borders.
+	auto conn_index = first_conn_index;
+	const auto conn_end = first_conn_index + weights.size();
+
+	lanes_t lanes{};
+
+	while (conn_index != conn_end) {
+		const auto chunk_index = conn_index / lane_count;
+		const auto chunk_begin = chunk_index * lane_count;
+		const auto lane_begin = conn_index - chunk_begin;
+		const auto lane_end = std::min(lane_count, conn_end - chunk_begin);
+
+		const auto chunk_weights = weights.begin() + (conn_index - first_conn_index);
+
+		std::copy(chunk_weights, chunk_weights + (lane_end - lane_begin), lanes.begin() + lane_begin);
+		if (distribution_config.perturbation == weight_perturbation_t::gaussian) {
+			mutate_lanes<weight_perturbation_t::gaussian>(
+				distribution_config, perturbation_rate, stream, chunk_index, lanes
+			);
+		} else {
+			mutate_lanes<weight_perturbation_t::uniform>(
+				distribution_config, perturbation_rate, stream, chunk_index, lanes
+			);
+		}
+		std::copy(lanes.begin() + lane_begin, lanes.begin() + lane_end, chunk_weights);
+
+		conn_index = chunk_begin + lane_end;
+	}
+}
+
+} // namespace neat
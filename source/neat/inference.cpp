@@ -1,18 +1,70 @@
 #include "neat/inference.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <numeric>
 
 namespace neat::inference {
 
+types::network_group_view_t::network_group_view_t(const network_group_t& network_group) :
+	networks{ network_group.networks },
+	incoming_connection_counts_and_node_lookups{ network_group.incoming_connection_counts_and_node_lookups },
+	connections{ network_group.connections } {
+}
+
 types::value_t activation_function(const types::value_t& signal) {
 	return types::value_t{ 1.0 } / (types::value_t{ 2.0 } + std::exp(types::value_t{ -4.9 } * signal));
 }
 
+// Afterwards the node values hold the inputs followed by the values of all nodes.
+static void evaluate_network(
+	const types::network_group_view_t& network_group,
+	const types::network_t& network,
+	const types::value_t* const inputs,
+	const std::size_t num_inputs,
+	debug_vector<types::value_t>& node_values
+) {
+	node_values.resize(num_inputs + network.incoming_connection_count_range.size());
+	std::copy_n(inputs, num_inputs, node_values.begin());
+	// Only unconnected output nodes need to be set to zero but this is easier/hopefully faster.
+	std::fill(node_values.begin() + num_inputs, node_values.end(), types::value_t{});
+
+	auto network_conn_it = network_group.connections.begin() + network.incoming_connections_begin;
+	const auto network_incoming_conn_counts = network.incoming_connection_count_range
+												  .cspan(
+													  network_group.incoming_connection_counts_and_node_lookups
+												  );
+
+	std::transform(
+		network_incoming_conn_counts.begin(),
+		network_incoming_conn_counts.end(),
+		node_values.begin() + num_inputs,
+		[&](const auto conn_count) {
+			const auto activation = std::accumulate(
+				network_conn_it,
+				network_conn_it + conn_count,
+				types::value_t{},
+				[&node_values](const auto& sum, const auto& conn) {
+					return sum + conn.weight * node_values[conn.source_node_index];
+				}
+			);
+			network_conn_it += conn_count;
+			return activation_function(activation);
+		}
+	);
+}
+
+static std::span<const types::rel_conn_index_t> output_node_lookup(
+	const types::network_group_view_t& network_group, const types::network_t& network, const std::size_t num_outputs
+) {
+	return std::span(network_group.incoming_connection_counts_and_node_lookups)
+		.subspan(network.incoming_connection_count_range.end(), num_outputs);
+}
+
 void evaluate_network_range(
-	const types::network_group_t& network_group,
+	const types::network_group_view_t& network_group,
 	debug_span<const types::value_t> network_inputs,
 	debug_span<types::value_t> network_outputs,
 	const neat::types::network_range_t& network_range
@@ -30,43 +82,194 @@ void evaluate_network_range(
 	for (const auto& network_index : network_range.indices()) {
 		const auto& network = network_group.networks[network_index];
 
-		node_values.resize(num_inputs + network.incoming_connection_count_range.size());
-		std::copy_n(&network_inputs[network_index * num_inputs], num_inputs, node_values.begin());
-		// Only unconnected output nodes need to be set to zero but this is easier/hopefully faster.
-		std::fill(node_values.begin() + num_inputs, node_values.end(), types::value_t{});
+		evaluate_network(network_group, network, &network_inputs[network_index * num_inputs], num_inputs, node_values);
+
+		const auto output_nodes = output_node_lookup(network_group, network, num_outputs);
+		std::transform(
+			output_nodes.begin(),
+			output_nodes.end(),
+			&network_outputs[network_index * num_outputs],
+			[&node_values](const auto& output_node_index) { return node_values[output_node_index]; }
+		);
+	}
+}
+
+// Words shared with a neighbouring range are updated atomically, as another thread might write its bits concurrently.
+static void store_decision_bits(
+	debug_span<std::uint64_t> decisions,
+	const std::size_t word_index,
+	const std::uint64_t bits,
+	const std::uint64_t mask
+) {
+	if (mask == ~std::uint64_t{}) {
+		decisions[word_index] = bits;
+	} else {
+		auto word = std::atomic_ref(decisions[word_index]);
+		word.fetch_and(~mask, std::memory_order_relaxed);
+		word.fetch_or(bits, std::memory_order_relaxed);
+	}
+}
+
+void evaluate_network_range_threshold(
+	const types::network_group_view_t& network_group,
+	debug_span<const types::value_t> network_inputs,
+	debug_span<std::uint64_t> decisions,
+	const types::value_t threshold,
+	const std::size_t num_outputs,
+	const neat::types::network_range_t& network_range
+) {
+	if (network_range.empty())
+		return;
+
+	static constexpr auto word_bit_count = std::size_t{ 64 };
+
+	assert(decisions.size() * word_bit_count >= network_group.networks.size() * num_outputs);
+
+	const auto num_inputs = network_inputs.size() / network_group.networks.size();
+
+	const auto bit_begin = network_range.begin() * num_outputs;
+	auto bit = bit_begin;
+	auto word = std::uint64_t{};
+
+	debug_vector<types::value_t> node_values;
+
+	for (const auto& network_index : network_range.indices()) {
+		const auto& network = network_group.networks[network_index];
+
+		evaluate_network(network_group, network, &network_inputs[network_index * num_inputs], num_inputs, node_values);
+
+		for (const auto& output_node_index : output_node_lookup(network_group, network, num_outputs)) {
+			word |= std::uint64_t{ node_values[output_node_index] > threshold } << (bit % word_bit_count);
+			++bit;
+
+			if (bit % word_bit_count == 0 or bit == network_range.end() * num_outputs) {
+				const auto word_index = (bit - 1) / word_bit_count;
+				const auto first_bit = std::max(bit_begin, word_index * word_bit_count) - word_index * word_bit_count;
+				const auto bit_count = bit - word_index * word_bit_count - first_bit;
+				const auto mask = bit_count == word_bit_count ? ~std::uint64_t{}
+				                                              : ((std::uint64_t{ 1 } << bit_count) - 1) << first_bit;
+				store_decision_bits(decisions, word_index, word, mask);
+				word = 0;
+			}
+		}
+	}
+}
+
+void evaluate_network_range_argmax(
+	const types::network_group_view_t& network_group,
+	debug_span<const types::value_t> network_inputs,
+	debug_span<types::output_index_t> output_indices,
+	const std::size_t num_outputs,
+	const neat::types::network_range_t& network_range
+) {
+	if (network_range.empty())
+		return;
+
+	assert(output_indices.size() == network_group.networks.size());
+	assert(num_outputs != 0 and num_outputs - 1 <= std::numeric_limits<types::output_index_t>::max());
+
+	const auto num_inputs = network_inputs.size() / network_group.networks.size();
+
+	debug_vector<types::value_t> node_values;
+
+	for (const auto& network_index : network_range.indices()) {
+		const auto& network = network_group.networks[network_index];
+
+		evaluate_network(network_group, network, &network_inputs[network_index * num_inputs], num_inputs, node_values);
+
+		const auto output_nodes = output_node_lookup(network_group, network, num_outputs);
+		const auto max_it = std::max_element(
+			output_nodes.begin(),
+			output_nodes.end(),
+			[&node_values](const auto& a, const auto& b) { return node_values[a] < node_values[b]; }
+		);
+		output_indices[network_index] = static_cast<types::output_index_t>(max_it - output_nodes.begin());
+	}
+}
+
+void reset_recurrent_state(const types::network_group_view_t& network_group, types::recurrent_state_t& state) {
+	auto& [network_value_begins, node_values] = state;
+
+	network_value_begins.resize(network_group.networks.size());
+
+	auto value_count = types::abs_conn_index_t{};
+	for (std::size_t network_index{}; network_index != network_group.networks.size(); ++network_index) {
+		network_value_begins[network_index] = value_count;
+		value_count += network_group.networks[network_index].incoming_connection_count_range.size();
+	}
+
+	node_values.assign(value_count, types::value_t{});
+}
+
+void evaluate_network_range(
+	const types::network_group_view_t& network_group,
+	types::recurrent_state_t& state,
+	debug_span<const types::value_t> network_inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range,
+	const std::uint32_t step_count
+) {
+	if (network_range.empty())
+		return;
+
+	assert(network_outputs.size() % network_group.networks.size() == 0);
+	assert(state.network_value_begins.size() == network_group.networks.size());
+
+	const auto num_inputs = network_inputs.size() / network_group.networks.size();
+	const auto num_outputs = network_outputs.size() / network_group.networks.size();
+
+	// The inputs followed by the node values of the previous step.
+	debug_vector<types::value_t> previous_values;
+
+	for (const auto& network_index : network_range.indices()) {
+		const auto& network = network_group.networks[network_index];
 
-		auto network_conn_it = network_group.connections.begin() + network.incoming_connections_begin;
 		const auto network_incoming_conn_counts = network.incoming_connection_count_range
 													  .cspan(
 														  network_group.incoming_connection_counts_and_node_lookups
 													  );
+		const auto node_values = std::span(state.node_values)
+									 .subspan(
+										 state.network_value_begins[network_index],
+										 network_incoming_conn_counts.size()
+									 );
 
-		std::transform(
-			network_incoming_conn_counts.begin(),
-			network_incoming_conn_counts.end(),
-			node_values.begin(),
-			[&](const auto conn_count) {
-				const auto activation = std::accumulate(
-					network_conn_it,
-					network_conn_it + conn_count,
-					types::value_t{},
-					[&node_values](const auto& sum, const auto& conn) {
-						return sum + conn.weight * node_values[conn.source_node_index];
-					}
-				);
-				network_conn_it += conn_count;
-				return activation_function(activation);
-			}
-		);
+		previous_values.resize(num_inputs + node_values.size());
+		std::copy_n(&network_inputs[network_index * num_inputs], num_inputs, previous_values.begin());
+
+		for (std::uint32_t step{}; step != step_count; ++step) {
+			std::copy(node_values.begin(), node_values.end(), previous_values.begin() + num_inputs);
+
+			auto network_conn_it = network_group.connections.begin() + network.incoming_connections_begin;
+
+			std::transform(
+				network_incoming_conn_counts.begin(),
+				network_incoming_conn_counts.end(),
+				node_values.begin(),
+				[&](const auto conn_count) {
+					const auto activation = std::accumulate(
+						network_conn_it,
+						network_conn_it + conn_count,
+						types::value_t{},
+						[&previous_values](const auto& sum, const auto& conn) {
+							return sum + conn.weight * previous_values[conn.source_node_index];
+						}
+					);
+					network_conn_it += conn_count;
+					return activation_function(activation);
+				}
+			);
+		}
 
 		const auto output_node_lookup = std::span(network_group.incoming_connection_counts_and_node_lookups)
 										 .subspan(network.incoming_connection_count_range.end(), num_outputs);
 
+		// Outputs are never inputs, so they can be read from the values of the last step.
 		std::transform(
 			output_node_lookup.begin(),
 			output_node_lookup.end(),
 			&network_outputs[network_index * num_outputs],
-			[&node_values](const auto& output_node_index) { return node_values[output_node_index]; }
+			[&](const auto& output_node_index) { return node_values[output_node_index - num_inputs]; }
 		);
 	}
 }
@@ -0,0 +1,256 @@
+#include "neat/layered_inference.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <span>
+
+namespace neat::inference {
+
+void compile_layered_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	const layer_config_t& layer_config,
+	types::layered_network_group_t& layered_network_group
+) {
+	const auto input_count = static_cast<types::node_index_t>(network_interface_config.input_count);
+	const auto output_count = network_interface_config.output_count;
+
+	auto& [layered_networks, layers, dense_weights, incoming_connection_counts, connections, output_node_lookups] =
+		layered_network_group;
+
+	layered_networks.resize(network_group.networks.size());
+	layers.clear();
+	dense_weights.clear();
+	incoming_connection_counts.clear();
+	connections.clear();
+	output_node_lookups.clear();
+
+	// Per node buffers, reused between networks.
+	debug_vector<types::node_index_t> node_layers;
+	debug_vector<types::abs_conn_index_t> node_connection_begins;
+	debug_vector<types::node_index_t> node_positions;
+	debug_vector<types::node_index_t> layer_nodes;
+	debug_vector<types::node_index_t> layer_offsets;
+
+	for (std::size_t network_index{}; network_index != network_group.networks.size(); ++network_index) {
+		const auto& network = network_group.networks[network_index];
+		auto& layered_network = layered_networks[network_index];
+
+		const auto network_incoming_conn_counts = network.incoming_connection_count_range.cspan(
+			network_group.incoming_connection_counts_and_node_lookups
+		);
+		const auto node_count = static_cast<types::node_index_t>(network_incoming_conn_counts.size());
+
+		// The nodes are compiled in topological order, so the layers of all sources are known before their
+		// destination. Nodes that only depend on inputs form the first layer.
+		node_layers.resize(node_count);
+		node_connection_begins.resize(node_count);
+
+		auto layer_count = types::node_index_t{};
+		auto conn_index = network.incoming_connections_begin;
+		for (types::node_index_t node{}; node != node_count; ++node) {
+			node_connection_begins[node] = conn_index;
+
+			auto layer = types::node_index_t{};
+			const auto conn_end = conn_index + network_incoming_conn_counts[node];
+			for (; conn_index != conn_end; ++conn_index) {
+				const auto source = network_group.connections[conn_index].source_node_index;
+				if (source >= input_count) {
+					assert(source - input_count < node);
+					layer = std::max(layer, node_layers[source - input_count] + 1);
+				}
+			}
+
+			node_layers[node] = layer;
+			layer_count = std::max(layer_count, layer + 1);
+		}
+
+		// Counting sort of the nodes by layer, which keeps the topological order inside of every layer.
+		layer_offsets.assign(layer_count + 1, 0);
+		for (const auto& layer : node_layers) {
+			++layer_offsets[layer + 1];
+		}
+		std::partial_sum(layer_offsets.begin(), layer_offsets.end(), layer_offsets.begin());
+
+		node_positions.resize(node_count);
+		layer_nodes.resize(node_count);
+		for (types::node_index_t node{}; node != node_count; ++node) {
+			const auto position = layer_offsets[node_layers[node]]++;
+			node_positions[node] = position;
+			layer_nodes[position] = node;
+		}
+
+		const auto value_index = [&](const types::node_index_t source) {
+			return source < input_count ? source : input_count + node_positions[source - input_count];
+		};
+
+		layered_network.layers.begin() = layers.size();
+		layered_network.layers.clear();
+
+		auto layer_begin = types::node_index_t{};
+		for (types::node_index_t layer_index{}; layer_index != layer_count; ++layer_index) {
+			// The offsets were shifted by the sort, every entry now holds the end of its layer.
+			const auto layer_end = layer_offsets[layer_index];
+			const auto nodes = std::span(layer_nodes).subspan(layer_begin, layer_end - layer_begin);
+
+			const auto for_each_connection = [&](const types::node_index_t node, auto&& function) {
+				const auto conn_begin = node_connection_begins[node];
+				const auto conn_end = conn_begin + network_incoming_conn_counts[node];
+				for (auto conn_it = conn_begin; conn_it != conn_end; ++conn_it) {
+					function(network_group.connections[conn_it]);
+				}
+			};
+
+			auto source_begin = std::numeric_limits<types::node_index_t>::max();
+			auto source_end = types::node_index_t{};
+			auto layer_connection_count = std::size_t{};
+			for (const auto& node : nodes) {
+				for_each_connection(node, [&](const types::weighted_connection_t& conn) {
+					const auto source = value_index(conn.source_node_index);
+					source_begin = std::min(source_begin, source);
+					source_end = std::max(source_end, source + 1);
+					++layer_connection_count;
+				});
+			}
+
+			auto layer = types::layer_t{ .kind = types::layer_kind_t::sparse,
+				                         .node_begin = input_count + layer_begin,
+				                         .node_count = layer_end - layer_begin };
+
+			const auto matrix_size = layer_connection_count == 0
+				? std::size_t{}
+				: nodes.size() * static_cast<std::size_t>(source_end - source_begin);
+			const auto is_dense = matrix_size != 0 and static_cast<float>(layer_connection_count) >=
+				layer_config.min_dense_density * static_cast<float>(matrix_size);
+
+			if (is_dense) {
+				layer.kind = types::layer_kind_t::dense;
+				layer.source_begin = source_begin;
+				layer.source_count = source_end - source_begin;
+				layer.weights_begin = dense_weights.size();
+
+				dense_weights.resize(dense_weights.size() + matrix_size, types::value_t{});
+				const auto matrix = std::span(dense_weights).subspan(layer.weights_begin, matrix_size);
+
+				for (std::size_t row{}; row != nodes.size(); ++row) {
+					for_each_connection(nodes[row], [&](const types::weighted_connection_t& conn) {
+						const auto column = value_index(conn.source_node_index) - source_begin;
+						matrix[row * layer.source_count + column] += conn.weight;
+					});
+				}
+			} else {
+				layer.incoming_connection_counts_begin = incoming_connection_counts.size();
+				layer.connections_begin = connections.size();
+
+				for (const auto& node : nodes) {
+					incoming_connection_counts.push_back(network_incoming_conn_counts[node]);
+					for_each_connection(node, [&](const types::weighted_connection_t& conn) {
+						connections.push_back({ .source_node_index = value_index(conn.source_node_index),
+						                        .weight = conn.weight });
+					});
+				}
+			}
+
+			// Sparse layers are evaluated node by node anyway, so consecutive ones are merged to save the per layer
+			// overhead on the many small layers of typical networks.
+			const auto extends_sparse_layer = layer.kind == types::layer_kind_t::sparse and
+				not layered_network.layers.empty() and layers.back().kind == types::layer_kind_t::sparse;
+			if (extends_sparse_layer) {
+				layers.back().node_count += layer.node_count;
+			} else {
+				layers.push_back(layer);
+				++layered_network.layers.end();
+			}
+
+			layer_begin = layer_end;
+		}
+
+		layered_network.value_count = input_count + node_count;
+		layered_network.output_node_lookup_begin = output_node_lookups.size();
+
+		const auto output_node_lookup = std::span(network_group.incoming_connection_counts_and_node_lookups)
+											.subspan(network.incoming_connection_count_range.end(), output_count);
+		for (const auto& output_node_index : output_node_lookup) {
+			output_node_lookups.push_back(value_index(output_node_index));
+		}
+	}
+}
+
+void evaluate_network_range(
+	const types::layered_network_group_t& network_group,
+	debug_span<const types::value_t> network_inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range
+) {
+	if (network_range.empty())
+		return;
+
+	assert(network_outputs.size() % network_group.networks.size() == 0);
+
+	const auto num_inputs = network_inputs.size() / network_group.networks.size();
+	const auto num_outputs = network_outputs.size() / network_group.networks.size();
+
+	debug_vector<types::value_t> node_values;
+
+	for (const auto& network_index : network_range.indices()) {
+		const auto& network = network_group.networks[network_index];
+
+		node_values.resize(network.value_count);
+		std::copy_n(&network_inputs[network_index * num_inputs], num_inputs, node_values.begin());
+
+		for (const auto& layer : network.layers.cspan(network_group.layers)) {
+			auto node_value_it = node_values.begin() + layer.node_begin;
+
+			if (layer.kind == types::layer_kind_t::dense) {
+				// All rows read the same consecutive values, so the loads need no index decoding.
+				const auto sources = std::span(node_values).subspan(layer.source_begin, layer.source_count);
+				auto row_it = network_group.dense_weights.begin() + layer.weights_begin;
+
+				for (types::node_index_t row{}; row != layer.node_count; ++row) {
+					const auto activation = std::inner_product(
+						sources.begin(),
+						sources.end(),
+						row_it,
+						types::value_t{}
+					);
+					row_it += layer.source_count;
+					*node_value_it++ = activation_function(activation);
+				}
+			} else {
+				const auto layer_incoming_conn_counts = std::span(network_group.incoming_connection_counts)
+															.subspan(
+																layer.incoming_connection_counts_begin,
+																layer.node_count
+															);
+				auto conn_it = network_group.connections.begin() + layer.connections_begin;
+
+				for (const auto& conn_count : layer_incoming_conn_counts) {
+					const auto activation = std::accumulate(
+						conn_it,
+						conn_it + conn_count,
+						types::value_t{},
+						[&node_values](const auto& sum, const auto& conn) {
+							return sum + conn.weight * node_values[conn.source_node_index];
+						}
+					);
+					conn_it += conn_count;
+					*node_value_it++ = activation_function(activation);
+				}
+			}
+		}
+
+		const auto output_node_lookup = std::span(network_group.output_node_lookups)
+											.subspan(network.output_node_lookup_begin, num_outputs);
+
+		std::transform(
+			output_node_lookup.begin(),
+			output_node_lookup.end(),
+			&network_outputs[network_index * num_outputs],
+			[&node_values](const auto& output_node_index) { return node_values[output_node_index]; }
+		);
+	}
+}
+
+} // namespace neat::inference
@@ -0,0 +1,326 @@
+#include "neat/network_group_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace neat::inference {
+
+static_assert(std::is_trivially_copyable_v<types::network_t>, "Networks are stored as raw bytes.");
+static_assert(std::is_trivially_copyable_v<types::weighted_connection_t>, "Connections are stored as raw bytes.");
+static_assert(std::is_trivially_copyable_v<network_group_file_header_t>, "The header is stored as raw bytes.");
+
+namespace {
+
+class network_group_file_category_t : public std::error_category {
+public:
+	[[nodiscard]] const char* name() const noexcept override {
+		return "network_group_file";
+	}
+
+	[[nodiscard]] std::string message(int error) const override {
+		switch (static_cast<network_group_file_error>(error)) {
+		case network_group_file_error::ok:
+			return "ok";
+		case network_group_file_error::invalid_magic:
+			return "file is not a network group file";
+		case network_group_file_error::unsupported_version:
+			return "unsupported network group file version";
+		case network_group_file_error::incompatible_layout:
+			return "network group file was written with an incompatible memory layout";
+		case network_group_file_error::truncated_file:
+			return "network group file is truncated";
+		case network_group_file_error::corrupt_contents:
+			return "network group file references data outside of its arrays";
+		}
+		return "unknown network group file error";
+	}
+};
+
+std::uint64_t align_offset(const std::uint64_t offset) {
+	constexpr auto alignment = network_group_file_header_t::file_alignment;
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+network_group_file_header_t create_header(
+	const types::network_group_view_t& network_group, const network_interface_config_t& network_interface_config
+) {
+	auto header = network_group_file_header_t{};
+
+	header.magic = network_group_file_header_t::magic_value;
+	header.version = network_group_file_header_t::current_version;
+
+	header.network_size = sizeof(types::network_t);
+	header.node_lookup_size = sizeof(types::rel_conn_index_t);
+	header.connection_size = sizeof(types::weighted_connection_t);
+
+	header.input_count = network_interface_config.input_count;
+	header.output_count = network_interface_config.output_count;
+
+	header.network_count = network_group.networks.size();
+	header.node_lookup_count = network_group.incoming_connection_counts_and_node_lookups.size();
+	header.connection_count = network_group.connections.size();
+
+	header.network_offset = align_offset(sizeof(network_group_file_header_t));
+	header.node_lookup_offset = align_offset(header.network_offset + header.network_count * header.network_size);
+	header.connection_offset = align_offset(
+		header.node_lookup_offset + header.node_lookup_count * header.node_lookup_size
+	);
+	header.file_size = header.connection_offset + header.connection_count * header.connection_size;
+
+	return header;
+}
+
+std::error_code validate_header(const network_group_file_header_t& header, const std::size_t file_size) {
+	if (header.magic != network_group_file_header_t::magic_value) {
+		return network_group_file_error::invalid_magic;
+	}
+	if (header.version != network_group_file_header_t::current_version) {
+		return network_group_file_error::unsupported_version;
+	}
+	if (header.network_size != sizeof(types::network_t) or header.node_lookup_size != sizeof(types::rel_conn_index_t) or
+	    header.connection_size != sizeof(types::weighted_connection_t)) {
+		return network_group_file_error::incompatible_layout;
+	}
+
+	const auto array_fits = [&](const std::uint64_t offset, const std::uint64_t count, const std::uint64_t size) {
+		return offset % network_group_file_header_t::file_alignment == 0 and offset <= file_size and
+			count <= (file_size - offset) / size;
+	};
+
+	if (header.file_size > file_size or
+	    not array_fits(header.network_offset, header.network_count, header.network_size) or
+	    not array_fits(header.node_lookup_offset, header.node_lookup_count, header.node_lookup_size) or
+	    not array_fits(header.connection_offset, header.connection_count, header.connection_size)) {
+		return network_group_file_error::truncated_file;
+	}
+
+	return {};
+}
+
+// The evaluators index the arrays without bounds checks, so every range and index of every network is checked once
+// when mapping instead.
+std::error_code validate_contents(
+	const types::network_group_view_t& network_group, const std::uint64_t input_count, const std::uint64_t output_count
+) {
+	const auto node_lookup_count = network_group.incoming_connection_counts_and_node_lookups.size();
+	const auto connection_count = network_group.connections.size();
+
+	constexpr auto max_node_count = std::uint64_t{ std::numeric_limits<types::node_index_t>::max() };
+	if (input_count > max_node_count or output_count > max_node_count) {
+		return network_group_file_error::corrupt_contents;
+	}
+
+	for (const auto& network : network_group.networks) {
+		const auto node_range = network.incoming_connection_count_range;
+		if (node_range.begin() > node_range.end() or node_range.end() > node_lookup_count or
+		    output_count > node_lookup_count - node_range.end()) {
+			return network_group_file_error::corrupt_contents;
+		}
+
+		const auto value_count = input_count + node_range.size();
+		const auto is_value_index = [&](const std::uint64_t index) {
+			return index < value_count;
+		};
+
+		if (network.incoming_connections_begin > connection_count) {
+			return network_group_file_error::corrupt_contents;
+		}
+		auto network_connection_count = std::uint64_t{};
+		for (const auto& conn_count : node_range.cspan(network_group.incoming_connection_counts_and_node_lookups)) {
+			network_connection_count += conn_count;
+			if (network_connection_count > connection_count - network.incoming_connections_begin) {
+				return network_group_file_error::corrupt_contents;
+			}
+		}
+
+		const auto connections = network_group.connections.subspan(
+			network.incoming_connections_begin,
+			network_connection_count
+		);
+		const auto output_node_lookup = network_group.incoming_connection_counts_and_node_lookups.subspan(
+			node_range.end(),
+			output_count
+		);
+		if (not std::ranges::all_of(connections, is_value_index, &types::weighted_connection_t::source_node_index) or
+		    not std::ranges::all_of(output_node_lookup, is_value_index)) {
+			return network_group_file_error::corrupt_contents;
+		}
+	}
+
+	return {};
+}
+
+template<typename T>
+void write_array(std::ofstream& file, const std::uint64_t offset, debug_span<const T> data) {
+	static constexpr auto padding = std::array<char, network_group_file_header_t::file_alignment>{};
+
+	const auto position = static_cast<std::uint64_t>(file.tellp());
+	file.write(padding.data(), static_cast<std::streamsize>(offset - position));
+	file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size_bytes()));
+}
+
+} // namespace
+
+const std::error_category& network_group_file_category() {
+	static const auto category = network_group_file_category_t{};
+	return category;
+}
+
+std::error_code make_error_code(const network_group_file_error error) {
+	return { static_cast<int>(error), network_group_file_category() };
+}
+
+std::error_code save_network_group(
+	const std::filesystem::path& path,
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config
+) {
+	const auto header = create_header(network_group, network_interface_config);
+
+	auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+	if (not file) {
+		return std::make_error_code(std::errc::io_error);
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	write_array(file, header.network_offset, network_group.networks);
+	write_array(file, header.node_lookup_offset, network_group.incoming_connection_counts_and_node_lookups);
+	write_array(file, header.connection_offset, network_group.connections);
+
+	file.flush();
+	if (not file) {
+		return std::make_error_code(std::errc::io_error);
+	}
+
+	return {};
+}
+
+//--------------------[ mapped_network_group ]--------------------//
+
+mapped_network_group::mapped_network_group(mapped_network_group&& other) noexcept :
+	m_data{ std::exchange(other.m_data, nullptr) },
+	m_size{ std::exchange(other.m_size, 0) },
+	m_view{ std::exchange(other.m_view, {}) },
+	m_network_interface_config{ other.m_network_interface_config } {
+}
+
+mapped_network_group& mapped_network_group::operator=(mapped_network_group&& other) noexcept {
+	if (this != &other) {
+		unmap();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_view = std::exchange(other.m_view, {});
+		m_network_interface_config = other.m_network_interface_config;
+	}
+	return *this;
+}
+
+mapped_network_group::~mapped_network_group() {
+	unmap();
+}
+
+std::error_code mapped_network_group::map(const std::filesystem::path& path) {
+	unmap();
+
+	const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd == -1) {
+		return { errno, std::generic_category() };
+	}
+
+	struct stat file_stat {};
+	if (::fstat(fd, &file_stat) == -1) {
+		const auto error = errno;
+		::close(fd);
+		return { error, std::generic_category() };
+	}
+
+	const auto file_size = static_cast<std::size_t>(file_stat.st_size);
+	if (file_size < sizeof(network_group_file_header_t)) {
+		::close(fd);
+		return network_group_file_error::truncated_file;
+	}
+
+	auto data = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	const auto mmap_error = errno;
+	// The mapping keeps its own reference to the file.
+	::close(fd);
+
+	if (data == MAP_FAILED) {
+		return { mmap_error, std::generic_category() };
+	}
+
+	// The header is copied instead of accessed in place to not rely on its alignment.
+	auto header = network_group_file_header_t{};
+	std::memcpy(&header, data, sizeof(header));
+
+	if (const auto error = validate_header(header, file_size)) {
+		::munmap(data, file_size);
+		return error;
+	}
+
+	// Prefetch the whole file in the background so first evaluations don't stall on page faults.
+	::madvise(data, file_size, MADV_WILLNEED);
+
+	const auto bytes = static_cast<const std::byte*>(data);
+
+	auto view = types::network_group_view_t{};
+	view.networks = debug_span(
+		reinterpret_cast<const types::network_t*>(bytes + header.network_offset),
+		header.network_count
+	);
+	view.incoming_connection_counts_and_node_lookups = debug_span(
+		reinterpret_cast<const types::rel_conn_index_t*>(bytes + header.node_lookup_offset),
+		header.node_lookup_count
+	);
+	view.connections = debug_span(
+		reinterpret_cast<const types::weighted_connection_t*>(bytes + header.connection_offset),
+		header.connection_count
+	);
+
+	if (const auto error = validate_contents(view, header.input_count, header.output_count)) {
+		::munmap(data, file_size);
+		return error;
+	}
+
+	m_data = data;
+	m_size = file_size;
+	m_view = view;
+
+	m_network_interface_config = { .input_count = header.input_count, .output_count = header.output_count };
+
+	return {};
+}
+
+void mapped_network_group::unmap() {
+	if (m_data != nullptr) {
+		::munmap(m_data, m_size);
+		m_data = nullptr;
+		m_size = 0;
+		m_view = {};
+	}
+}
+
+bool mapped_network_group::is_mapped() const {
+	return m_data != nullptr;
+}
+
+const types::network_group_view_t& mapped_network_group::view() const {
+	return m_view;
+}
+
+const network_interface_config_t& mapped_network_group::network_interface_config() const {
+	return m_network_interface_config;
+}
+
+} // namespace neat::inference
@@ -0,0 +1,88 @@
+#include "neat/network_group_order.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+namespace neat::inference {
+
+void reorder_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	const network_order_t order,
+	types::network_group_t& reordered_network_group,
+	debug_vector<neat::types::network_index_t>& original_network_indices
+) {
+	const auto output_count = network_interface_config.output_count;
+	const auto network_count = network_group.networks.size();
+
+	// The networks store where their connections begin, so the counts are summed up once to get their ends.
+	debug_vector<types::abs_conn_index_t> connection_counts(network_count);
+	for (std::size_t network_index{}; network_index != network_count; ++network_index) {
+		const auto& network = network_group.networks[network_index];
+		const auto incoming_conn_counts = network.incoming_connection_count_range.cspan(
+			network_group.incoming_connection_counts_and_node_lookups
+		);
+		connection_counts[network_index] = std::accumulate(
+			incoming_conn_counts.begin(),
+			incoming_conn_counts.end(),
+			types::abs_conn_index_t{}
+		);
+	}
+
+	const auto sort_key = [&](const neat::types::network_index_t network_index) {
+		const auto node_count = network_group.networks[network_index].incoming_connection_count_range.size();
+		return order == network_order_t::shape ? std::tuple(node_count, connection_counts[network_index])
+		                                       : std::tuple(connection_counts[network_index], node_count);
+	};
+
+	original_network_indices.resize(network_count);
+	std::iota(original_network_indices.begin(), original_network_indices.end(), neat::types::network_index_t{});
+	std::stable_sort(
+		original_network_indices.begin(),
+		original_network_indices.end(),
+		[&](const auto& a, const auto& b) { return sort_key(a) < sort_key(b); }
+	);
+
+	auto& [networks, incoming_connection_counts_and_node_lookups, connections] = reordered_network_group;
+
+	networks.resize(network_count);
+	incoming_connection_counts_and_node_lookups.clear();
+	incoming_connection_counts_and_node_lookups.reserve(
+		network_group.incoming_connection_counts_and_node_lookups.size()
+	);
+	connections.clear();
+	connections.reserve(network_group.connections.size());
+
+	for (std::size_t network_index{}; network_index != network_count; ++network_index) {
+		const auto original_network_index = original_network_indices[network_index];
+		const auto& original_network = network_group.networks[original_network_index];
+		auto& network = networks[network_index];
+
+		const auto node_count = original_network.incoming_connection_count_range.size();
+		network.incoming_connection_count_range = types::abs_conn_index_range_t::from_index_count(
+			incoming_connection_counts_and_node_lookups.size(),
+			node_count
+		);
+		network.incoming_connections_begin = connections.size();
+
+		// Node indices are relative to the network, so the counts, output node lookup and connections are copied as is.
+		const auto counts_and_lookup_begin = network_group.incoming_connection_counts_and_node_lookups.begin() +
+			static_cast<std::ptrdiff_t>(original_network.incoming_connection_count_range.begin());
+		incoming_connection_counts_and_node_lookups.insert(
+			incoming_connection_counts_and_node_lookups.end(),
+			counts_and_lookup_begin,
+			counts_and_lookup_begin + static_cast<std::ptrdiff_t>(node_count + output_count)
+		);
+
+		const auto connections_begin = network_group.connections.begin() +
+			static_cast<std::ptrdiff_t>(original_network.incoming_connections_begin);
+		connections.insert(
+			connections.end(),
+			connections_begin,
+			connections_begin + static_cast<std::ptrdiff_t>(connection_counts[original_network_index])
+		);
+	}
+}
+
+} // namespace neat::inference
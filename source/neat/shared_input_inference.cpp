@@ -0,0 +1,166 @@
+#include "neat/shared_input_inference.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <span>
+
+namespace neat::inference {
+
+void compile_shared_input_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	const input_layout_t& input_layout,
+	types::shared_input_network_group_t& shared_input_network_group
+) {
+	const auto input_count = static_cast<types::node_index_t>(network_interface_config.input_count);
+	const auto output_count = network_interface_config.output_count;
+
+	assert(input_layout.sources.size() == input_count);
+	assert(input_layout.constant_values.size() == input_count);
+
+	auto& [compiled_network_group, node_offsets, per_network_input_count, shared_input_count] =
+		shared_input_network_group;
+	auto& [networks, incoming_connection_counts_and_node_lookups, connections] = compiled_network_group;
+
+	per_network_input_count = static_cast<types::node_index_t>(
+		std::count(input_layout.sources.begin(), input_layout.sources.end(), input_source_t::per_network)
+	);
+	shared_input_count = static_cast<types::node_index_t>(
+		std::count(input_layout.sources.begin(), input_layout.sources.end(), input_source_t::shared)
+	);
+	const auto constant_input_count = input_count - per_network_input_count - shared_input_count;
+
+	// Per network inputs come first, so their rows can be copied without gaps.
+	debug_vector<types::node_index_t> input_value_indices(input_count, invalid_node_index);
+	auto next_per_network_index = types::node_index_t{};
+	auto next_shared_index = per_network_input_count;
+	for (types::node_index_t input{}; input != input_count; ++input) {
+		if (input_layout.sources[input] == input_source_t::per_network) {
+			input_value_indices[input] = next_per_network_index++;
+		} else if (input_layout.sources[input] == input_source_t::shared) {
+			input_value_indices[input] = next_shared_index++;
+		}
+	}
+
+	const auto value_index = [&](const types::node_index_t source) {
+		return source < input_count ? input_value_indices[source] : source - constant_input_count;
+	};
+
+	networks.resize(network_group.networks.size());
+	const auto node_count = network_group.incoming_connection_counts_and_node_lookups.size();
+	incoming_connection_counts_and_node_lookups.resize(node_count);
+	node_offsets.resize(node_count);
+	connections.clear();
+	connections.reserve(network_group.connections.size());
+
+	for (std::size_t network_index{}; network_index != network_group.networks.size(); ++network_index) {
+		const auto& network = network_group.networks[network_index];
+		auto& compiled_network = networks[network_index];
+
+		// The nodes keep their place, only the connections of constant inputs are left out.
+		compiled_network.incoming_connection_count_range = network.incoming_connection_count_range;
+		compiled_network.incoming_connections_begin = connections.size();
+
+		auto conn_it = network_group.connections.begin() + network.incoming_connections_begin;
+
+		for (const auto& node : network.incoming_connection_count_range.indices()) {
+			const auto conn_end = conn_it + network_group.incoming_connection_counts_and_node_lookups[node];
+
+			auto offset = types::value_t{};
+			auto kept_connection_count = types::rel_conn_index_t{};
+			for (; conn_it != conn_end; ++conn_it) {
+				const auto& [source, weight] = *conn_it;
+				if (source < input_count and input_layout.sources[source] == input_source_t::constant) {
+					offset += weight * input_layout.constant_values[source];
+				} else {
+					connections.push_back({ .source_node_index = value_index(source), .weight = weight });
+					++kept_connection_count;
+				}
+			}
+
+			incoming_connection_counts_and_node_lookups[node] = kept_connection_count;
+			node_offsets[node] = offset;
+		}
+
+		const auto output_node_lookup = network_group.incoming_connection_counts_and_node_lookups.subspan(
+			network.incoming_connection_count_range.end(),
+			output_count
+		);
+		std::transform(
+			output_node_lookup.begin(),
+			output_node_lookup.end(),
+			incoming_connection_counts_and_node_lookups.begin() + network.incoming_connection_count_range.end(),
+			value_index
+		);
+	}
+}
+
+void evaluate_network_range(
+	const types::shared_input_network_group_t& network_group,
+	debug_span<const types::value_t> shared_inputs,
+	debug_span<const types::value_t> network_inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range
+) {
+	if (network_range.empty())
+		return;
+
+	const auto& [networks, incoming_connection_counts_and_node_lookups, connections] = network_group.network_group;
+
+	assert(network_outputs.size() % networks.size() == 0);
+	assert(network_inputs.size() == networks.size() * network_group.per_network_input_count);
+	assert(shared_inputs.size() == network_group.shared_input_count);
+
+	const auto num_inputs = std::size_t{ network_group.per_network_input_count };
+	const auto num_input_values = num_inputs + shared_inputs.size();
+	const auto num_outputs = network_outputs.size() / networks.size();
+
+	// The shared inputs are copied once, as the values of the networks only replace what comes before and after them.
+	debug_vector<types::value_t> node_values(num_input_values);
+	std::copy(shared_inputs.begin(), shared_inputs.end(), node_values.begin() + num_inputs);
+
+	for (const auto& network_index : network_range.indices()) {
+		const auto& network = networks[network_index];
+
+		node_values.resize(num_input_values + network.incoming_connection_count_range.size());
+		std::copy_n(&network_inputs[network_index * num_inputs], num_inputs, node_values.begin());
+
+		auto network_conn_it = connections.begin() + network.incoming_connections_begin;
+		const auto network_incoming_conn_counts = network.incoming_connection_count_range.cspan(
+			incoming_connection_counts_and_node_lookups
+		);
+		const auto network_node_offsets = network.incoming_connection_count_range.cspan(network_group.node_offsets);
+
+		std::transform(
+			network_incoming_conn_counts.begin(),
+			network_incoming_conn_counts.end(),
+			network_node_offsets.begin(),
+			node_values.begin() + num_input_values,
+			[&](const auto conn_count, const auto offset) {
+				const auto activation = std::accumulate(
+					network_conn_it,
+					network_conn_it + conn_count,
+					offset,
+					[&node_values](const auto& sum, const auto& conn) {
+						return sum + conn.weight * node_values[conn.source_node_index];
+					}
+				);
+				network_conn_it += conn_count;
+				return activation_function(activation);
+			}
+		);
+
+		const auto output_node_lookup = std::span(incoming_connection_counts_and_node_lookups)
+											.subspan(network.incoming_connection_count_range.end(), num_outputs);
+
+		std::transform(
+			output_node_lookup.begin(),
+			output_node_lookup.end(),
+			&network_outputs[network_index * num_outputs],
+			[&node_values](const auto& output_node_index) { return node_values[output_node_index]; }
+		);
+	}
+}
+
+} // namespace neat::inference
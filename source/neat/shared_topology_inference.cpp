@@ -0,0 +1,230 @@
+#include "neat/shared_topology_inference.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <unordered_map>
+
+namespace neat::inference {
+
+// Networks evaluated side by side, limited so the node values of a batch of large networks still fit into the cache.
+static constexpr std::size_t max_batch_size = 64;
+
+struct network_topology_view_t {
+	debug_span<const types::rel_conn_index_t> incoming_connection_counts_and_node_lookup;
+	debug_span<const types::weighted_connection_t> connections;
+};
+
+static network_topology_view_t network_topology(
+	const types::network_group_view_t& network_group, const types::network_t& network, const std::size_t output_count
+) {
+	auto connection_count = std::size_t{};
+	for (const auto& conn_count : network.incoming_connection_count_range.cspan(
+			 network_group.incoming_connection_counts_and_node_lookups
+		 )) {
+		connection_count += conn_count;
+	}
+
+	const auto node_lookup_begin = network_group.incoming_connection_counts_and_node_lookups.data() +
+		network.incoming_connection_count_range.begin();
+	const auto node_lookup_size = network.incoming_connection_count_range.size() + output_count;
+	const auto connections_begin = network_group.connections.data() + network.incoming_connections_begin;
+
+	return { .incoming_connection_counts_and_node_lookup = { node_lookup_begin, node_lookup_size },
+		     .connections = { connections_begin, connection_count } };
+}
+
+static std::size_t topology_hash(const network_topology_view_t& topology) {
+	auto hash = std::size_t{ 0xcbf29ce484222325 };
+	const auto combine = [&](const std::uint32_t value) {
+		hash = (hash ^ value) * std::size_t{ 0x100000001b3 };
+	};
+
+	for (const auto& value : topology.incoming_connection_counts_and_node_lookup) {
+		combine(value);
+	}
+	for (const auto& conn : topology.connections) {
+		combine(conn.source_node_index);
+	}
+
+	return hash;
+}
+
+static bool equal_topologies(const network_topology_view_t& a, const network_topology_view_t& b) {
+	return std::ranges::equal(
+			   a.incoming_connection_counts_and_node_lookup, b.incoming_connection_counts_and_node_lookup
+		   ) and
+		std::ranges::equal(a.connections, b.connections, {}, &types::weighted_connection_t::source_node_index,
+		                   &types::weighted_connection_t::source_node_index);
+}
+
+void compile_shared_topology_network_group(
+	const types::network_group_view_t& network_group,
+	const network_interface_config_t& network_interface_config,
+	types::shared_topology_network_group_t& shared_topology_network_group
+) {
+	const auto output_count = network_interface_config.output_count;
+	const auto network_count = network_group.networks.size();
+
+	auto& [topologies, network_indices, incoming_connection_counts_and_node_lookups, source_node_indices, weights,
+	       shared_network_count] = shared_topology_network_group;
+
+	topologies.clear();
+	network_indices.resize(network_count);
+	incoming_connection_counts_and_node_lookups.clear();
+	source_node_indices.clear();
+	weights.resize(network_group.connections.size());
+	shared_network_count = network_count;
+
+	// Assign every network to the first network with the same topology, which represents the topology.
+	debug_vector<std::uint32_t> network_topology_indices(network_count);
+	debug_vector<neat::types::network_index_t> representatives;
+	std::unordered_map<std::size_t, debug_vector<std::uint32_t>> topologies_by_hash;
+
+	for (neat::types::network_index_t network_index{}; network_index != network_count; ++network_index) {
+		const auto topology = network_topology(network_group, network_group.networks[network_index], output_count);
+		auto& candidates = topologies_by_hash[topology_hash(topology)];
+
+		const auto match = std::find_if(candidates.begin(), candidates.end(), [&](const std::uint32_t topology_index) {
+			const auto& representative = network_group.networks[representatives[topology_index]];
+			return equal_topologies(topology, network_topology(network_group, representative, output_count));
+		});
+
+		if (match != candidates.end()) {
+			network_topology_indices[network_index] = *match;
+			++topologies[*match].networks.end();
+		} else {
+			const auto topology_index = static_cast<std::uint32_t>(topologies.size());
+			candidates.push_back(topology_index);
+			representatives.push_back(network_index);
+			network_topology_indices[network_index] = topology_index;
+
+			auto& shared_topology = topologies.emplace_back();
+			shared_topology.networks = types::abs_conn_index_range_t::from_index_count(0, 1);
+			shared_topology.incoming_connection_count_range = types::abs_conn_index_range_t::from_index_count(
+				incoming_connection_counts_and_node_lookups.size(),
+				network_group.networks[network_index].incoming_connection_count_range.size()
+			);
+			shared_topology.source_node_indices_begin = source_node_indices.size();
+			shared_topology.connection_count = topology.connections.size();
+
+			incoming_connection_counts_and_node_lookups.insert(
+				incoming_connection_counts_and_node_lookups.end(),
+				topology.incoming_connection_counts_and_node_lookup.begin(),
+				topology.incoming_connection_counts_and_node_lookup.end()
+			);
+			for (const auto& conn : topology.connections) {
+				source_node_indices.push_back(conn.source_node_index);
+			}
+		}
+	}
+
+	// The network counts become consecutive ranges of network indices and weights.
+	auto networks_begin = types::abs_conn_index_t{};
+	auto weights_begin = types::abs_conn_index_t{};
+	for (auto& topology : topologies) {
+		const auto topology_network_count = topology.networks.size();
+		topology.networks = types::abs_conn_index_range_t::from_index_count(networks_begin, topology_network_count);
+		topology.weights_begin = weights_begin;
+		networks_begin += topology_network_count;
+		weights_begin += topology_network_count * topology.connection_count;
+	}
+
+	debug_vector<types::abs_conn_index_t> topology_columns(topologies.size());
+
+	for (neat::types::network_index_t network_index{}; network_index != network_count; ++network_index) {
+		const auto topology_index = network_topology_indices[network_index];
+		const auto& topology = topologies[topology_index];
+		const auto column = topology_columns[topology_index]++;
+		network_indices[topology.networks.begin() + column] = network_index;
+
+		const auto stride = static_cast<std::ptrdiff_t>(topology.networks.size());
+		const auto connections = network_topology(network_group, network_group.networks[network_index], output_count)
+									 .connections;
+		auto weight_it = weights.begin() + static_cast<std::ptrdiff_t>(topology.weights_begin + column);
+		for (const auto& conn : connections) {
+			*weight_it = conn.weight;
+			weight_it += stride;
+		}
+	}
+}
+
+void evaluate_network_range(
+	const types::shared_topology_network_group_t& network_group,
+	debug_span<const types::value_t> network_inputs,
+	debug_span<types::value_t> network_outputs,
+	const neat::types::network_range_t& network_range
+) {
+	if (network_range.empty())
+		return;
+
+	assert(network_outputs.size() % network_group.network_count == 0);
+
+	const auto num_inputs = network_inputs.size() / network_group.network_count;
+	const auto num_outputs = network_outputs.size() / network_group.network_count;
+
+	// Node major, the values of one node are consecutive for all networks of the batch.
+	debug_vector<types::value_t> node_values;
+
+	for (const auto& topology : network_group.topologies) {
+		const auto topology_network_indices = topology.networks.cspan(network_group.network_indices);
+		const auto first = std::lower_bound(
+			topology_network_indices.begin(), topology_network_indices.end(), network_range.begin()
+		);
+		const auto last = std::lower_bound(first, topology_network_indices.end(), network_range.end());
+
+		const auto incoming_conn_counts = topology.incoming_connection_count_range.cspan(
+			network_group.incoming_connection_counts_and_node_lookups
+		);
+		const auto output_node_lookup = std::span(network_group.incoming_connection_counts_and_node_lookups)
+											.subspan(topology.incoming_connection_count_range.end(), num_outputs);
+		const auto stride = static_cast<std::ptrdiff_t>(topology.networks.size());
+
+		for (auto batch_begin = first; batch_begin != last;) {
+			const auto batch_size = std::min(static_cast<std::size_t>(last - batch_begin), max_batch_size);
+			const auto batch = std::span(batch_begin, batch_size);
+			const auto column = batch_begin - topology_network_indices.begin();
+			batch_begin += static_cast<std::ptrdiff_t>(batch_size);
+
+			node_values.resize((num_inputs + incoming_conn_counts.size()) * batch_size);
+			for (std::size_t input{}; input != num_inputs; ++input) {
+				for (std::size_t i{}; i != batch_size; ++i) {
+					node_values[input * batch_size + i] = network_inputs[batch[i] * num_inputs + input];
+				}
+			}
+
+			auto source_it = network_group.source_node_indices.begin() +
+				static_cast<std::ptrdiff_t>(topology.source_node_indices_begin);
+			auto weight_it = network_group.weights.begin() + static_cast<std::ptrdiff_t>(topology.weights_begin) +
+				column;
+			auto node_value_it = node_values.begin() + static_cast<std::ptrdiff_t>(num_inputs * batch_size);
+
+			for (const auto& conn_count : incoming_conn_counts) {
+				const auto activations = std::span(node_value_it, batch_size);
+				std::fill(activations.begin(), activations.end(), types::value_t{});
+
+				for (types::rel_conn_index_t conn{}; conn != conn_count; ++conn) {
+					const auto source_values = node_values.begin() +
+						static_cast<std::ptrdiff_t>(*source_it++ * batch_size);
+					for (std::size_t i{}; i != batch_size; ++i) {
+						activations[i] += weight_it[static_cast<std::ptrdiff_t>(i)] * source_values[i];
+					}
+					weight_it += stride;
+				}
+
+				std::transform(activations.begin(), activations.end(), activations.begin(), activation_function);
+				node_value_it += static_cast<std::ptrdiff_t>(batch_size);
+			}
+
+			for (std::size_t output{}; output != num_outputs; ++output) {
+				const auto output_values = node_values.begin() +
+					static_cast<std::ptrdiff_t>(output_node_lookup[output] * batch_size);
+				for (std::size_t i{}; i != batch_size; ++i) {
+					network_outputs[batch[i] * num_outputs + output] = output_values[i];
+				}
+			}
+		}
+	}
+}
+
+} // namespace neat::inference
@@ -1,26 +1,69 @@
 #include "neat/trainer.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
 #include <functional>
-#include <iostream> // TODO remove
 #include <numeric>
+#include <random>
 #include <thread>
+#include "util/parallel_scan.hpp"
 
 namespace neat {
 
+static numa_topology make_numa_topology(const execution_config_t& execution_config) {
+	const auto& affinity = execution_config.affinity;
+
+	auto topology = numa_topology{};
+	if (execution_config.numa_policy == numa_policy_t::partitioned) {
+		topology = execution_config.fake_numa_node_count != 0
+			? numa_topology::fake(execution_config.fake_numa_node_count)
+			: numa_topology::detect();
+	} else if (affinity.policy == affinity_policy_t::pinned or affinity.avoid_smt_siblings or
+	           affinity.reserved_core_count != 0) {
+		// Without partitioning, all CPUs are treated as one node.
+		topology = numa_topology::fake(1);
+	}
+	topology.restrict_worker_cpus(affinity.avoid_smt_siblings, affinity.reserved_core_count);
+
+	return topology;
+}
+
 trainer::trainer(
 	const evolution_config_t& evolution_config,
 	const network_interface_config_t& network_interface_config,
 	const std::size_t population_size,
-	const std::uint32_t thread_count
+	const std::uint32_t thread_count,
+	const seed_t seed,
+	const execution_config_t& execution_config
 ) :
 	m_evolution_config{ evolution_config },
 	m_network_interface_config{ network_interface_config },
 	m_population_size{ population_size },
-	m_thread_count{ thread_count } {
+	m_thread_count{ thread_count },
+	m_execution_config{ execution_config },
+	m_numa_topology{ make_numa_topology(execution_config) },
+	m_seed{ seed } {
 	create_initial_population();
-	// TOD use rnd to initialize rng
+}
+
+trainer::~trainer() {
+	if (m_evolution_thread.joinable()) {
+		m_evolution_thread.join();
+	}
+}
+
+philox_rng trainer::make_rng(
+	const std::uint32_t generation, const rng_purpose_t purpose, const std::uint32_t index
+) const {
+	return philox_rng(m_seed, generation, index, static_cast<std::uint32_t>(purpose));
+}
+
+weight_mutation_stream_t trainer::weight_mutation_stream(const std::uint32_t generation) const {
+	return { .key = philox_rng::make_key(m_seed),
+		     .generation = generation,
+		     .purpose = static_cast<std::uint32_t>(rng_purpose_t::weight_mutation_kernel) };
 }
 
 void trainer::create_initial_population() {
@@ -43,14 +86,171 @@ void trainer::create_initial_population() {
 
 void trainer::evolve(
 	debug_span<const types::fitness_t> ancestor_fitness, inference::types::network_group_t& network_group
+) {
+	wait_for_generation();
+	reset_compiled_networks(nullptr);
+	evolve_generation(ancestor_fitness, network_group);
+}
+
+void trainer::evolve_async(debug_span<const types::fitness_t> ancestor_fitness) {
+	wait_for_generation();
+
+	m_async_ancestor_fitness.assign(ancestor_fitness.begin(), ancestor_fitness.end());
+	m_network_group_index = (m_network_group_index + 1) % m_network_groups.size();
+	reset_compiled_networks(&m_network_groups[m_network_group_index]);
+
+	m_evolution_thread = std::thread([this]() {
+		evolve_generation(m_async_ancestor_fitness, m_network_groups[m_network_group_index]);
+	});
+}
+
+const inference::types::network_group_t& trainer::wait_for_networks(const types::network_range_t& network_range) {
+	auto lock = std::unique_lock(m_compiled_networks_mutex);
+
+	// Only the networks of the population are ever compiled.
+	assert(network_range.end() <= m_population_size);
+
+	// Without an asynchronous generation no section will be added, so waiting would never end.
+	assert(m_compiled_network_group != nullptr);
+	if (m_compiled_network_group == nullptr) {
+		return m_network_groups[m_network_group_index];
+	}
+
+	// The sections don't overlap, so the range is complete once the overlaps add up to its size.
+	m_compiled_networks_condition.wait(lock, [&]() {
+		auto compiled_count = types::network_index_t{};
+		for (const auto& section : m_compiled_network_sections) {
+			const auto begin = std::max(section.begin(), network_range.begin());
+			const auto end = std::min(section.end(), network_range.end());
+			if (begin < end) {
+				compiled_count += end - begin;
+			}
+		}
+		return compiled_count == network_range.size();
+	});
+
+	return *m_compiled_network_group;
+}
+
+const inference::types::network_group_t& trainer::wait_for_generation() {
+	if (m_evolution_thread.joinable()) {
+		m_evolution_thread.join();
+	}
+	return m_network_groups[m_network_group_index];
+}
+
+void trainer::reset_compiled_networks(const inference::types::network_group_t* const network_group) {
+	const auto lock = std::lock_guard(m_compiled_networks_mutex);
+	m_compiled_network_sections.clear();
+	m_compiled_network_group = network_group;
+	// The generation is only counted once it starts.
+	m_compiled_generation = m_generation_count + 1;
+}
+
+void trainer::mark_networks_compiled(const types::network_range_t& network_range) {
+	{
+		const auto lock = std::lock_guard(m_compiled_networks_mutex);
+		if (m_compiled_network_group == nullptr) {
+			return;
+		}
+		assert(m_generation_count == m_compiled_generation);
+		m_compiled_network_sections.push_back(network_range);
+	}
+	m_compiled_networks_condition.notify_all();
+}
+
+void trainer::place_worker(const types::network_index_t network_index) const {
+	// The default topology has no CPUs, so there is nothing to restrict the workers to.
+	if (m_numa_topology.cpus(0).empty()) {
+		return;
+	}
+
+	const auto placed = m_execution_config.affinity.policy == affinity_policy_t::pinned
+		? m_numa_topology.pin_current_thread(std::size_t{ network_index }, m_population_size)
+		: m_numa_topology.pin_current_thread(m_numa_topology.partition_node(network_index, m_population_size));
+	if (not placed) {
+		++m_failed_placement_count;
+	}
+
+	phase_recorder::worker_placed();
+}
+
+placement_stats_t trainer::placement_stats() {
+	auto stats = placement_stats_t{ .numa_node_count = m_numa_topology.node_count(),
+		                            .pinned = m_execution_config.affinity.policy == affinity_policy_t::pinned,
+		                            .failed_placement_count = m_failed_placement_count.exchange(0) };
+	for (std::uint32_t node{}; node != m_numa_topology.node_count(); ++node) {
+		stats.worker_cpu_count += static_cast<std::uint32_t>(m_numa_topology.cpus(node).size());
+	}
+	return stats;
+}
+
+monotonic_arena& trainer::worker_arena(const std::size_t worker_index) {
+	while (m_worker_arenas.size() <= worker_index) {
+		m_worker_arenas.push_back(std::make_unique<monotonic_arena>());
+	}
+	return *m_worker_arenas[worker_index];
+}
+
+void trainer::reset_arenas() {
+	m_arena.reset();
+	for (auto& arena : m_worker_arenas) {
+		arena->reset();
+	}
+}
+
+arena_stats_t trainer::arena_stats() {
+	auto stats = m_arena.stats();
+	for (auto& arena : m_worker_arenas) {
+		const auto worker_stats = arena->stats();
+		stats.upstream_allocation_count += worker_stats.upstream_allocation_count;
+		stats.bytes_used += worker_stats.bytes_used;
+		stats.capacity += worker_stats.capacity;
+	}
+	return stats;
+}
+
+template<typename T>
+void trainer::resize_partitioned(hugepage_vector<T>& data, const std::size_t size) const {
+	if (m_execution_config.numa_policy == numa_policy_t::none or size <= data.capacity()) {
+		data.resize(size);
+		return;
+	}
+
+	// Growing would copy the old elements on this thread, which places all pages on its node.
+	// The reserve leaves room for a few more generations of growth before the pages are placed again.
+	// The fresh buffer is placed before the resize writes to it, so no page has to be released and moved.
+	data = hugepage_vector<T>();
+	data.reserve(size + size / 2);
+	const auto byte_count = data.capacity() * sizeof(T);
+	m_numa_topology.first_touch(data.data(), byte_count, backing_page_size(byte_count));
+	data.resize(size);
+}
+
+void trainer::evolve_generation(
+	debug_span<const types::fitness_t> ancestor_fitness, inference::types::network_group_t& network_group
 ) {
 	auto& ancestors = m_populations[m_current_generation_index];
 	swap_population();
 	auto& offspring = m_populations[m_current_generation_index];
+
+	++m_generation_count;
+	reset_arenas();
+
+	m_phase_recorder.begin_generation();
 	evolve_into(ancestors, ancestor_fitness, offspring);
-	std::cout << "update_inference_network_group" << std::endl;
 	update_inference_network_group(network_group);
-	std::cout << "done with update_inference_network_group" << std::endl;
+	m_phase_recorder.stats().arena = arena_stats();
+	m_phase_recorder.stats().placement = placement_stats();
+	m_phase_recorder.end_generation();
+}
+
+const generation_stats_t& trainer::last_generation_stats() const {
+	return m_phase_recorder.stats();
+}
+
+void trainer::place_inference_worker(const types::network_range_t& network_range) const {
+	place_worker(network_range.begin());
 }
 
 void trainer::swap_population() {
@@ -58,63 +258,63 @@ void trainer::swap_population() {
 }
 
 void trainer::mutate_all_connections(
+	const std::uint32_t generation,
 	debug_span<const types::network_t> offspring_networks,
 	debug_span<types::connection_weight_t> offspring_connection_weights,
 	const types::network_range_t& conn_mutation_range
 ) {
-
-	auto chance_distrib = std::uniform_real_distribution<float>(0.0f, 1.0f);
-	auto weight_distrib = std::uniform_real_distribution<float>(
-		m_evolution_config.weight_distribution_config.conn_weight_min,
-		m_evolution_config.weight_distribution_config.conn_weight_max
-	);
-	auto weight_offset_distrib = std::uniform_real_distribution<float>(
-		m_evolution_config.weight_distribution_config.conn_weight_offset_min,
-		m_evolution_config.weight_distribution_config.conn_weight_offset_max
-	);
+	const auto stream = weight_mutation_stream(generation);
+
+	// Neighbouring networks usually have neighbouring connections, so they are mutated as one continuous range.
+	auto conn_range = types::conn_range_t{};
+	const auto flush_conn_range = [&]() {
+		mutate_weights(
+			m_evolution_config.weight_distribution_config,
+			m_evolution_config.mutation_rate_config.uniform_mutation_rate,
+			stream,
+			conn_range.begin(),
+			conn_range.span(offspring_connection_weights)
+		);
+	};
 
 	for (const auto& offspring_network : conn_mutation_range.span(offspring_networks)) {
-		for (auto& weight : offspring_network.connections.span(offspring_connection_weights)) {
-			if (chance_distrib(m_rng) < m_evolution_config.mutation_rate_config.uniform_mutation_rate) {
-				weight += weight_offset_distrib(m_rng);
-			} else {
-				weight = weight_distrib(m_rng);
-			}
+		if (offspring_network.connections.begin() != conn_range.end()) {
+			flush_conn_range();
+			conn_range = offspring_network.connections;
+		} else {
+			conn_range.end() = offspring_network.connections.end();
 		}
 	}
+	flush_conn_range();
 }
 
 void trainer::mutate_some_connections(
+	const std::uint32_t generation,
 	debug_span<const types::network_t> offspring_networks,
 	debug_span<types::connection_weight_t> offspring_connection_weights,
 	const types::network_range_t& conn_mutation_range
 ) {
+	const auto stream = weight_mutation_stream(generation);
 
 	auto chance_distrib = std::uniform_real_distribution<float>(0.0f, 1.0f);
-	auto weight_distrib = std::uniform_real_distribution<float>(
-		m_evolution_config.weight_distribution_config.conn_weight_min,
-		m_evolution_config.weight_distribution_config.conn_weight_max
-	);
-
-	auto weight_offset_distrib = std::uniform_real_distribution<float>(
-		m_evolution_config.weight_distribution_config.conn_weight_offset_min,
-		m_evolution_config.weight_distribution_config.conn_weight_offset_max
-	);
 
-	for (const auto& offspring_network : conn_mutation_range.span(offspring_networks)) {
-		if (chance_distrib(m_rng) < m_evolution_config.mutation_rate_config.network_mutation_rate) {
-			for (auto& weight : offspring_network.connections.span(offspring_connection_weights)) {
-				if (chance_distrib(m_rng) < m_evolution_config.mutation_rate_config.uniform_mutation_rate) {
-					weight += weight_offset_distrib(m_rng);
-				} else {
-					weight = weight_distrib(m_rng);
-				}
-			}
+	for (const auto& network_index : conn_mutation_range.indices()) {
+		auto rng = make_rng(generation, rng_purpose_t::weight_mutation, network_index);
+		if (chance_distrib(rng) < m_evolution_config.mutation_rate_config.network_mutation_rate) {
+			const auto& connections = offspring_networks[network_index].connections;
+			mutate_weights(
+				m_evolution_config.weight_distribution_config,
+				m_evolution_config.mutation_rate_config.uniform_mutation_rate,
+				stream,
+				connections.begin(),
+				connections.span(offspring_connection_weights)
+			);
 		}
 	}
 }
 
 void trainer::apply_add_conn_mutations(
+	const std::uint32_t generation,
 	debug_span<const types::network_t> ancestor_networks,
 	debug_span<const types::connection_t> ancestor_connections,
 	debug_span<const types::network_index_t> ancestor_lookup,
@@ -122,11 +322,9 @@ void trainer::apply_add_conn_mutations(
 	debug_span<types::connection_t> offspring_connections,
 	debug_span<types::connection_weight_t> offspring_connection_weights,
 	debug_span<types::connection_info_t> offspring_connection_infos,
+	connection_sampler& sampler,
 	const types::network_range_t& add_conn_mutation_range
 ) {
-	debug_vector<bool> dst_nodes_taken;
-	debug_vector<types::node_index_t> node_stack;
-
 	auto weight_distrib = std::uniform_real_distribution<types::connection_weight_t>(
 		m_evolution_config.weight_distribution_config.conn_weight_min,
 		m_evolution_config.weight_distribution_config.conn_weight_max
@@ -134,6 +332,8 @@ void trainer::apply_add_conn_mutations(
 
 	for (const auto& network_index : add_conn_mutation_range.indices()) {
 
+		auto rng = make_rng(generation, rng_purpose_t::add_conn_mutation, network_index);
+
 		const auto& ancestor_network = ancestor_networks[ancestor_lookup[network_index]];
 		const auto& ancestor_network_connections = ancestor_network.connections.span(ancestor_connections);
 
@@ -143,72 +343,19 @@ void trainer::apply_add_conn_mutations(
 			offspring_connection_weights
 		);
 
-		const auto num_src_nodes = m_network_interface_config.input_count + ancestor_network.hidden_node_count;
-		const auto num_dst_nodes = m_network_interface_config.output_count + ancestor_network.hidden_node_count;
-		dst_nodes_taken.resize(num_dst_nodes);
-
-		using node_dist_t = std::uniform_int_distribution<types::node_index_t>;
-
-		auto from_distrib = node_dist_t(0, num_src_nodes - 1);
-		auto to_distrib = node_dist_t(
-			m_network_interface_config.input_count,
-			m_network_interface_config.input_count + num_dst_nodes - 1
+		// All connections that neither exist yet nor create a loop are collected up front,
+		// so a valid connection is drawn uniformly in a single try.
+		sampler.assign(
+			m_network_interface_config,
+			ancestor_network.hidden_node_count,
+			ancestor_network_connections,
+			m_evolution_config.connectivity == connectivity_t::recurrent
 		);
 
-		auto from_index{ invalid_node_index }, to_index{ invalid_node_index };
-
-		// TODO This number doesn't have a deeper meaning. Fix it.
-		auto tries_left = num_src_nodes * num_dst_nodes + 1;
-		auto connection_valid = false;
-		while (tries_left--) {
-			from_index = from_distrib(m_rng);
-			// input | output | hidden
-			// -> output indices need to be skipped.
-			if (from_index >= m_network_interface_config.input_count) {
-				from_index += m_network_interface_config.output_count;
-			}
-
-			// TODO remove all num's
-
-			std::fill(dst_nodes_taken.begin(), dst_nodes_taken.end(), false);
-			for (const auto& conn : ancestor_network_connections) {
-				if (conn.from == from_index) {
-					const auto lookup_index = conn.to - m_network_interface_config.input_count;
-					assert(lookup_index < dst_nodes_taken.size());
-					dst_nodes_taken[lookup_index] = true;
-				}
-			}
-
-			const auto num_dst_nodes_taken = std::accumulate(
-				dst_nodes_taken.begin(),
-				dst_nodes_taken.end(),
-				types::node_index_t{}
-			);
-
-			if (num_dst_nodes_taken == num_dst_nodes) {
-				continue;
-			}
-
-			// If the src node is hidden and fully connected, it is obviously not connected to itself, which is
-			// addressed here.
-			if (((num_dst_nodes_taken + 1) == num_dst_nodes and from_index >= m_network_interface_config.input_count and
-			     not dst_nodes_taken[from_index - m_network_interface_config.input_count])) {
-				continue;
-			}
-
-			do {
-				to_index = to_distrib(m_rng);
-			} while (from_index == to_index or dst_nodes_taken[to_index - m_network_interface_config.input_count]);
-
-			if (would_create_loop(ancestor_connections, ancestor_network, from_index, to_index, node_stack)) {
-				continue;
-			}
-
-			connection_valid = true;
-			break;
-		}
+		if (sampler.candidate_count() != 0) {
+			auto candidate_distrib = std::uniform_int_distribution<std::size_t>(0, sampler.candidate_count() - 1);
+			const auto [from_index, to_index] = sampler.candidate(candidate_distrib(rng));
 
-		if (connection_valid) {
 			// The connections span was already extended to include one uninitialized connection.
 			// This connection can now be set.
 			assert(from_index < 140'736);
@@ -226,13 +373,8 @@ void trainer::apply_add_conn_mutations(
 			);
 
 			offspring_network_connections.back() = { .from = from_index, .to = to_index };
-			offspring_network_connection_weights.back() = weight_distrib(m_rng);
-			m_conn_lookup.update_connection_info(
-				offspring_connection_infos,
-				offspring_network.connections.end() - 1,
-				from_index,
-				to_index
-			);
+			offspring_network_connection_weights.back() = weight_distrib(rng);
+			// The innovation number is assigned later by assign_innovation_numbers.
 		} else {
 			// If no connections can be added give up, and leave the network unmodified.
 			--offspring_network.connections.end();
@@ -241,6 +383,7 @@ void trainer::apply_add_conn_mutations(
 }
 
 void trainer::apply_add_node_mutations(
+	const std::uint32_t generation,
 	debug_span<const types::network_t> ancestor_networks,
 	debug_span<const types::connection_t> ancestor_connections,
 	debug_span<const types::connection_weight_t> ancestor_connection_weights,
@@ -275,7 +418,8 @@ void trainer::apply_add_node_mutations(
 			0,
 			ancestor_network_connections.size() - 1
 		);
-		const auto split_connection_index = conn_distrib(m_rng);
+		auto rng = make_rng(generation, rng_purpose_t::add_node_mutation, network_index);
+		const auto split_connection_index = conn_distrib(rng);
 		const auto& split_connection = ancestor_network_connections[split_connection_index];
 		const auto& split_connection_weight = ancestor_connection_weights[split_connection_index];
 
@@ -308,56 +452,67 @@ void trainer::apply_add_node_mutations(
 
 		offspring_network_connection_weights[incoming_conn_index] = split_connection_weight;
 		offspring_network_connection_weights[outgoing_conn_index] = 1.0f;
+	}
+}
 
-		m_conn_lookup.update_connection_info(
-			offspring_connection_infos,
-			offspring_network.connections.begin() + incoming_conn_index,
-			offspring_network_connections[incoming_conn_index].from,
-			offspring_network_connections[incoming_conn_index].to
-		);
+void trainer::assign_innovation_numbers(
+	debug_span<const types::network_t> ancestor_networks,
+	debug_span<const types::network_index_t> ancestor_lookup,
+	debug_span<const types::network_t> offspring_networks,
+	debug_span<const types::connection_t> offspring_connections,
+	debug_span<types::connection_info_t> offspring_connection_infos,
+	const types::network_range_t& topological_mutation_range
+) {
+	// Innovation numbers are handed out in network order, so they don't depend on how the mutations were scheduled.
+	for (const auto& network_index : topological_mutation_range.indices()) {
+		const auto& ancestor_network = ancestor_networks[ancestor_lookup[network_index]];
+		const auto& offspring_network = offspring_networks[network_index];
 
-		m_conn_lookup.update_connection_info(
-			offspring_connection_infos,
-			offspring_network.connections.begin() + outgoing_conn_index,
-			offspring_network_connections[outgoing_conn_index].from,
-			offspring_network_connections[outgoing_conn_index].to
+		// Added connections are appended after the inherited ones.
+		const auto added_connections = types::conn_range_t::from_begin_end(
+			offspring_network.connections.begin() + ancestor_network.connections.size(),
+			offspring_network.connections.end()
 		);
+
+		for (const auto& conn_index : added_connections.indices()) {
+			const auto& [from, to] = offspring_connections[conn_index];
+			m_conn_lookup.update_connection_info(offspring_connection_infos, conn_index, from, to);
+		}
 	}
 }
 
 void trainer::create_crossovers(
+	const std::uint32_t generation,
 	const debug_span<const types::network_t> ancestor_networks,
 	const debug_span<const types::connection_t> ancestor_connections,
 	const debug_span<const types::connection_weight_t> ancestor_connection_weights,
 	const debug_span<const types::connection_info_t> ancestor_connection_infos,
 	const debug_span<const types::fitness_t> ancestor_fitness,
 	const debug_span<const types::parents_t> parents_lookup,
-	const debug_span<const seed_t> disjoint_excess_conn_selection_seeds,
 	const debug_span<types::network_t> offspring_networks,
-	const debug_span<types::connection_t> offspring_connections,
-	const debug_span<types::connection_weight_t> offspring_connection_weights,
-	const debug_span<types::connection_info_t> offspring_connection_infos,
-	const std::size_t seed_offset,
+	crossover_staging_t& staging,
+	const std::size_t parents_offset,
 	const types::network_range_t& crossover_range
 ) {
-	debug_vector<types::node_index_t> loop_detection_node_stack;
+	auto& offspring_order = staging.order;
 
 	auto parents_connection_selection_distrib = std::uniform_int_distribution<std::uint8_t>(false, true);
 	auto parents_connection_survival_distrib = std::uniform_int_distribution<std::uint8_t>(false, true);
 	auto chance_distrib = std::uniform_real_distribution<float>(0.0f, 1.0f);
 
-	std::default_random_engine disjoint_and_excess_conn_selection_engine{ 0 };
-
 	// The crossover_range needs to be indexed relative because the parents_lookup is already offset.
 	for (types::network_index_t i{}; i != crossover_range.size(); ++i) {
 
 		static constexpr auto num_parents = std::size_t{ 2 };
 
-		// Reset m_rng to replicate the decision done while counting the crossover connections.
-		disjoint_and_excess_conn_selection_engine.seed(disjoint_excess_conn_selection_seeds[seed_offset + i]);
-		parents_connection_survival_distrib.reset();
+		auto disjoint_and_excess_conn_selection_rng = make_rng(
+			generation,
+			rng_purpose_t::crossover_survival,
+			crossover_range.begin() + i
+		);
+		auto rng = make_rng(generation, rng_purpose_t::crossover_selection, crossover_range.begin() + i);
 
-		const auto& parent_indices = parents_lookup[seed_offset + i]; // TODO wtf?!?
+		const auto& parent_indices = parents_lookup[parents_offset + i];
 
 		std::array<types::conn_range_t, num_parents> parent_connection_its;
 		std::transform(
@@ -369,10 +524,6 @@ void trainer::create_crossovers(
 
 		auto& offspring_network = offspring_networks[crossover_range.begin() + i];
 
-		auto offspring_network_connections = offspring_network.connections.span(offspring_connections);
-		auto offspring_network_connection_weights = offspring_network.connections.span(offspring_connection_weights);
-		auto offspring_network_connection_infos = offspring_network.connections.span(offspring_connection_infos);
-
 		auto fit_index = types::network_index_t{ 0 }, unfit_index = types::network_index_t{ 1 };
 
 		std::array<types::fitness_t, num_parents> parent_fitness;
@@ -388,9 +539,22 @@ void trainer::create_crossovers(
 			std::swap(fit_index, unfit_index);
 		}
 
-		// Connections are cleared and gradually added to guarantee a valid network topology through-out the crossover
+		// Connections are gradually added to guarantee a valid network topology through-out the crossover
 		// process. This invariant is needed for loop detection.
-		offspring_network.connections.clear();
+		// Until compact_crossovers moves them, the connection range points into the staging buffers.
+		offspring_network.connections = types::conn_range_t::from_index_count(staging.connections.size(), 0);
+
+		const auto max_parent_hidden_node_count = std::max(
+			ancestor_networks[parent_indices[fit_index]].hidden_node_count,
+			ancestor_networks[parent_indices[unfit_index]].hidden_node_count
+		);
+		const auto check_loops = m_evolution_config.connectivity == connectivity_t::feed_forward;
+		if (check_loops) {
+			offspring_order.reset(
+				m_network_interface_config.input_count + m_network_interface_config.output_count +
+				max_parent_hidden_node_count
+			);
+		}
 
 		// TODO is max really a good idea? Wouldn't it be better to compress the node indices?
 		types::node_index_t offspring_max_node_index{ m_network_interface_config.input_count +
@@ -403,31 +567,22 @@ void trainer::create_crossovers(
 
 			// Connections that would create a loop are just left out.
 			// TODO consider inheriting another connection instead.
-			if (would_create_loop(
-					offspring_connections,
-					offspring_network,
-					ancestor_connection.from,
-					ancestor_connection.to,
-					loop_detection_node_stack
-				)) {
+			if (check_loops and
+			    not offspring_order.try_add_connection(ancestor_connection.from, ancestor_connection.to)) {
 				return;
 			}
 
-			const auto offspring_network_connection_index = offspring_network.connections.size();
+			const auto& offspring_connection = staging.connections.emplace_back(ancestor_connection);
 
-			// Maybe the indices are shifted?
-			auto& offspring_connection = offspring_network_connections
-				[offspring_network_connection_index] = ancestor_connection;
+			staging.connection_weights.push_back(ancestor_connection_weights[inherited_conn_index]);
 
-			offspring_network_connection_weights[offspring_network_connection_index] = ancestor_connection_weights
-				[inherited_conn_index];
-
-			auto& offspring_connection_info = offspring_network_connection_infos
-				[offspring_network_connection_index] = ancestor_connection_infos[inherited_conn_index];
+			auto& offspring_connection_info = staging.connection_infos.emplace_back(
+				ancestor_connection_infos[inherited_conn_index]
+			);
 
 			offspring_connection_info.enabled = not(
 				either_parent_deactivated and
-				chance_distrib(m_rng) < m_evolution_config.mutation_rate_config.keep_disabled_rate
+				chance_distrib(rng) < m_evolution_config.mutation_rate_config.keep_disabled_rate
 			);
 
 			offspring_max_node_index = std::max(
@@ -456,7 +611,7 @@ void trainer::create_crossovers(
 			bool either_parent_conn_deactivated{};
 
 			if (fit_inno_num == unfit_inno_num) { // matching gene
-				inherit_connection_index = parents_connection_selection_distrib(m_rng);
+				inherit_connection_index = parents_connection_selection_distrib(rng);
 				++fit_conn_index;
 				++unfit_conn_index;
 			} else {
@@ -468,10 +623,7 @@ void trainer::create_crossovers(
 					} else {
 						next_connection = unfit_index;
 					}
-					// A described before, if this was not done in a deterministic way,
-					// the number of offspring connections would not be predictable.
-
-					if (parents_connection_survival_distrib(disjoint_and_excess_conn_selection_engine)) {
+					if (parents_connection_survival_distrib(disjoint_and_excess_conn_selection_rng)) {
 						inherit_connection_index = next_connection;
 						either_parent_conn_deactivated = not(
 							ancestor_connection_infos[parent_connection_its[fit_index].begin()].enabled and
@@ -519,99 +671,30 @@ void trainer::create_crossovers(
 		offspring_network.hidden_node_count = offspring_max_node_index + 1 -
 			(m_network_interface_config.input_count + m_network_interface_config.output_count);
 		assert(offspring_network.hidden_node_count < 140'736);
-
-		// assert(offspring_network_connection_count == offspring_network.connections.size());
-		// offspring_network.connections.resize(offspring_network_connection_count);
 	}
 }
 
-std::size_t trainer::crossover_offspring_conn_count(
-	std::default_random_engine& disjoint_and_excess_connection_selection_engine,
-	std::uniform_int_distribution<std::uint8_t>& parents_connection_survival_distrib,
-	debug_span<const types::network_t> ancestor_networks,
-	debug_span<const types::connection_info_t> ancestor_connection_infos,
-	debug_span<const types::fitness_t> ancestor_fitness,
-	const types::parents_t& parent_indices
+void trainer::compact_crossovers(
+	const crossover_staging_t& staging,
+	const types::conn_index_t staging_offset,
+	debug_span<types::network_t> offspring_networks,
+	debug_span<types::connection_t> offspring_connections,
+	debug_span<types::connection_weight_t> offspring_connection_weights,
+	debug_span<types::connection_info_t> offspring_connection_infos,
+	const types::network_range_t& crossover_range
 ) {
-
-	static constexpr auto num_parents = std::size_t{ 2 };
-
-	std::array<types::conn_range_t, num_parents> parent_connection_its;
-	std::transform(
-		parent_indices.begin(),
-		parent_indices.end(),
-		parent_connection_its.begin(),
-		[&](const auto& parent_index) {
-			assert(parent_index < ancestor_networks.size());
-			return ancestor_networks[parent_index].connections;
-		}
-	);
-
-	auto fit_index = types::network_index_t{ 0 }, unfit_index = types::network_index_t{ 1 };
-
-	std::array<types::fitness_t, num_parents> parent_fitness;
-	std::transform(
-		parent_indices.begin(),
-		parent_indices.end(),
-		parent_fitness.begin(),
-		[&ancestor_fitness](const auto& parent_index) { return ancestor_fitness[parent_index]; }
-	);
-
-	const auto matching_fitness = does_fitness_match(parent_fitness[fit_index], parent_fitness[unfit_index]);
-	if (not matching_fitness and parent_fitness[fit_index] < parent_fitness[unfit_index]) {
-		std::swap(fit_index, unfit_index);
-	}
-
-	types::conn_index_t offspring_network_connection_count{};
-
-	while (std::none_of(parent_connection_its.begin(), parent_connection_its.end(), [](const auto& parent_connection) {
-		return parent_connection.empty();
-	})) {
-		auto& fit_conn_index = parent_connection_its[fit_index].begin();
-		auto& unfit_conn_index = parent_connection_its[unfit_index].begin();
-
-		const auto& fit_inno_num = ancestor_connection_infos[fit_conn_index].innovation_number;
-		const auto& unfit_inno_num = ancestor_connection_infos[unfit_conn_index].innovation_number;
-
-		if (fit_inno_num == unfit_inno_num) { // matching gene
-			++offspring_network_connection_count;
-			++fit_conn_index;
-			++unfit_conn_index;
-		} else {
-			const auto fit_connection_next = fit_inno_num < unfit_inno_num;
-			if (matching_fitness) { // matching fitness and matching gene
-				// A described before, if this was not done in a deterministic way,
-				// the number of offspring connections would not be predictable.
-				if (parents_connection_survival_distrib(disjoint_and_excess_connection_selection_engine)) {
-					++offspring_network_connection_count;
-				}
-			} else if (fit_connection_next) { // fit matching gene
-				++offspring_network_connection_count;
-			}
-			if (fit_connection_next) { // fit disjoint gene
-				++fit_conn_index;
-			} else { // unfit disjoint gene
-				++unfit_conn_index;
-			}
-		}
+	for (auto& offspring_network : crossover_range.span(offspring_networks)) {
+		auto& connections = offspring_network.connections;
+		connections = types::conn_range_t::from_index_count(staging_offset + connections.begin(), connections.size());
 	}
 
-	// Handler excess genes
-
-	const auto excess_range_it = std::find_if(
-		parent_connection_its.begin(),
-		parent_connection_its.end(),
-		[](const auto& parent_connection) { return not parent_connection.empty(); }
-	);
-
-	const auto excess_parent_index = static_cast<types::network_index_t>(
-		excess_range_it - parent_connection_its.begin()
-	);
-	if (excess_parent_index == fit_index or (excess_parent_index == unfit_index and matching_fitness)) {
-		offspring_network_connection_count += excess_range_it->size();
-	}
+	const auto copy_staging = [&](const auto& staged, const auto& offspring) {
+		std::copy(staged.begin(), staged.end(), offspring.begin() + staging_offset);
+	};
 
-	return offspring_network_connection_count;
+	copy_staging(staging.connections, offspring_connections);
+	copy_staging(staging.connection_weights, offspring_connection_weights);
+	copy_staging(staging.connection_infos, offspring_connection_infos);
 }
 
 void trainer::calc_species_fitness(
@@ -635,11 +718,12 @@ void trainer::calc_species_fitness(
 }
 
 void trainer::divide_offspring_between_species(
-	debug_span<const float> ancestor_species_fitness, debug_vector<types::network_index_t>& species_offspring_counts
+	debug_span<const float> ancestor_species_fitness, debug_span<types::network_index_t> species_offspring_counts
 ) {
-	// TODO put into class.
-	static debug_vector<std::pair<types::species_index_t, float>> flooring_errors;
-	flooring_errors.resize(ancestor_species_fitness.size());
+	arena_vector<std::pair<types::species_index_t, float>> flooring_errors(
+		ancestor_species_fitness.size(),
+		arena_allocator<std::pair<types::species_index_t, float>>(m_arena)
+	);
 
 	const auto [fitness_min_it, fitness_max_it] = std::minmax_element(
 		ancestor_species_fitness.begin(),
@@ -708,71 +792,24 @@ void trainer::divide_offspring_between_species(
 	}
 }
 
-bool trainer::would_create_loop(
-	debug_span<const types::connection_t> connections,
-	const types::network_t& network,
-	const types::conn_index_t& src_index,
-	const types::conn_index_t& dst_index,
-	debug_vector<types::node_index_t>& node_stack
-) const {
-
-	// This function assumes that without the given connection the network is well-formed and loop free.
-
-	const auto network_connections = network.connections.span(connections);
-
-	node_stack.clear();
-	node_stack.reserve(
-		m_network_interface_config.input_count + m_network_interface_config.output_count + network.hidden_node_count
-	);
-	node_stack.push_back(src_index);
-
-	std::size_t max_iterations = 100'000;
-
-	while (not node_stack.empty()) {
-
-		if (max_iterations-- == 0) {
-			std::cerr << "would_create_loop called on network that already contains loop!" << std::endl;
-			return true;
-		}
-
-		const auto node_index = node_stack.back();
-		node_stack.pop_back();
-
-		if (node_index < m_network_interface_config.input_count) {
-			// It is not possible for a single connection to add a loop with an input node,
-			// since no other connection can output to the input node.
-			continue;
-		}
-
-		for (const auto& incoming_conn : network_connections) {
-			if (incoming_conn.to == node_index) {
-				if (incoming_conn.from == dst_index) {
-					return true;
-				} else {
-					node_stack.push_back(incoming_conn.from);
-				}
-			}
-		}
-	}
-
-	return false;
-}
-
 bool trainer::does_fitness_match(const types::fitness_t& a, const types::fitness_t& b) const {
 	return std::abs(a - b) < m_evolution_config.fitness_epsilon;
 }
 
 void trainer::calculate_species_offspring_composition_and_sample_ancestors(
+	monotonic_arena& arena,
 	const debug_span<const types::species_t> all_ancestor_species,
 	const debug_span<const types::network_t> all_ancestor_networks,
 	const debug_span<const float> ancestor_species_fitness,
 	const debug_span<const types::network_index_t> species_offspring_counts,
 	const debug_span<types::population_composition_t> offspring_species_composition,
-	const debug_span<debug_vector<types::network_index_t>> species_ancestor_lookups,
+	const debug_span<arena_vector<types::network_index_t>> species_ancestor_lookups,
 	const types::species_range_t& species_range
 ) {
 	for (const auto& species_index : species_range.indices()) {
 
+		auto rng = make_rng(m_generation_count, rng_purpose_t::sampling, species_index);
+
 		const auto& ancestor_species = all_ancestor_species[species_index];
 
 		const auto species_fitness = ancestor_species.networks.span(ancestor_species_fitness);
@@ -783,7 +820,10 @@ void trainer::calculate_species_offspring_composition_and_sample_ancestors(
 		// One limits by ancestor population portion (So only a small portion goes extinct)
 		// The limits by ancestor fitness (So only ancestor with low fitness go extinct)
 
-		debug_vector<std::pair<types::network_index_t, float>> sorted_network_scores(species_fitness.size());
+		arena_vector<std::pair<types::network_index_t, float>> sorted_network_scores(
+			species_fitness.size(),
+			arena_allocator<std::pair<types::network_index_t, float>>(arena)
+		);
 		for (std::size_t i{}; i != species_fitness.size(); ++i) {
 			sorted_network_scores[i] = { i, species_fitness[i] };
 		}
@@ -844,7 +884,7 @@ void trainer::calculate_species_offspring_composition_and_sample_ancestors(
 
 		const auto calc_population_portion_count = [&](const double rate) {
 			std::binomial_distribution<std::size_t> distrib(species_offspring_count, rate);
-			return distrib(m_rng);
+			return distrib(rng);
 		};
 
 		//-----------------------[ mutation count ]-----------------------//
@@ -920,7 +960,10 @@ void trainer::calculate_species_offspring_composition_and_sample_ancestors(
 
 		// Now sample the ancestor indices
 		auto& species_ancestor_lookup = species_ancestor_lookups[species_index];
-		species_ancestor_lookup.resize(ancestor_count);
+		species_ancestor_lookup = arena_vector<types::network_index_t>(
+			ancestor_count,
+			arena_allocator<types::network_index_t>(arena)
+		);
 
 		auto ancestor_lookup_it = species_ancestor_lookup.begin();
 
@@ -938,7 +981,7 @@ void trainer::calculate_species_offspring_composition_and_sample_ancestors(
 		//-----------------------[ mutation ancestors ]-----------------------//
 
 		std::generate(ancestor_lookup_it, ancestor_lookup_it + mutated_ancestor_count, [&]() {
-			const auto ancestor = in_species_ancestor_index_distrib(m_rng);
+			const auto ancestor = in_species_ancestor_index_distrib(rng);
 			return ancestor;
 		});
 		ancestor_lookup_it += mutated_ancestor_count;
@@ -953,13 +996,13 @@ void trainer::calculate_species_offspring_composition_and_sample_ancestors(
 		auto parent_it = reinterpret_cast<types::parents_t*>(ancestor_lookup_it.base());
 
 		std::generate(parent_it, parent_it + in_species_crossovers_count, [&]() -> types::parents_t {
-			const auto parent_a_rng = in_species_ancestor_index_distrib(m_rng);
+			const auto parent_a_rng = in_species_ancestor_index_distrib(rng);
 			assert(parent_a_rng < ancestor_indices_scores.size());
 			auto parent_index_a = ancestor_indices_scores[parent_a_rng].first;
 
 			types::network_index_t parent_index_b;
 			do {
-				parent_index_b = ancestor_indices_scores[in_species_ancestor_index_distrib(m_rng)].first;
+				parent_index_b = ancestor_indices_scores[in_species_ancestor_index_distrib(rng)].first;
 			} while (parent_index_a == parent_index_b);
 
 			return { parent_index_a, parent_index_b };
@@ -969,11 +1012,11 @@ void trainer::calculate_species_offspring_composition_and_sample_ancestors(
 		//-----------------------[ inter-species-crossover parents ]-----------------------//
 
 		std::generate(parent_it, parent_it + inter_species_crossover_count, [&]() -> types::parents_t {
-			auto in_species_parent = in_species_ancestor_index_distrib(m_rng);
+			auto in_species_parent = in_species_ancestor_index_distrib(rng);
 
 			types::network_index_t external_species_parent;
 			do {
-				external_species_parent = all_ancestor_index_distrib(m_rng);
+				external_species_parent = all_ancestor_index_distrib(rng);
 			} while (ancestor_species.networks.contains(external_species_parent));
 			return { in_species_parent, external_species_parent };
 		});
@@ -1006,19 +1049,20 @@ void trainer::evolve_into(
 	debug_span<const types::fitness_t> ancestor_fitness,
 	types::population_t& offspring
 ) {
-	debug_vector<std::thread> threads;
+	// All temporaries come from the arena, which is reset every generation.
+	const auto allocator = arena_allocator<std::byte>(m_arena);
+
+	arena_vector<std::thread> threads(allocator);
 	threads.reserve(m_thread_count);
 
 	const auto ancestor_species_range = types::species_range_t::from_range(ancestors.species);
 	const auto ancestor_species_thread_segments = ancestor_species_range.balanced_segments(m_thread_count);
 
-	// std::cout << "|-------------[ calc_species_fitness ]-------------|" << std::endl;
-
-	debug_vector<float> ancestor_species_fitness(ancestors.species.size());
+	arena_vector<float> ancestor_species_fitness(ancestors.species.size(), allocator);
 	for (const auto& species_segment : ancestor_species_thread_segments) {
-		threads.emplace_back([&, species_segment]() {
+		threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::calc_species_fitness, [&, species_segment]() {
 			calc_species_fitness(ancestors.species, ancestor_fitness, ancestor_species_fitness, species_segment);
-		});
+		}));
 	}
 
 	for (auto& thread : threads) {
@@ -1026,21 +1070,24 @@ void trainer::evolve_into(
 	}
 	threads.clear();
 
-	// std::cout << "|-------------[ divide_offspring_between_species ]-------------|" << std::endl;
-
 	// Calculate every species portion of next generation proportional to species ancestor_fitness.
-	debug_vector<types::network_index_t> species_offspring_counts(ancestors.species.size());
+	const auto divide_offspring_begin = phase_recorder::clock_t::now();
+	arena_vector<types::network_index_t> species_offspring_counts(ancestors.species.size(), allocator);
 	divide_offspring_between_species(ancestor_species_fitness, species_offspring_counts);
+	m_phase_recorder.record(trainer_phase_t::divide_offspring, divide_offspring_begin, phase_recorder::clock_t::now());
 
-	debug_vector<types::population_composition_t> species_offspring_compositions(ancestors.species.size());
-	debug_vector<debug_vector<types::network_index_t>> species_ancestor_lookups(ancestors.species.size());
-
-	// std::cout << "|-------------[ calculate_species_offspring_composition_and_sample_ancestors ]-------------|" <<
-	// std::endl;
+	arena_vector<types::population_composition_t> species_offspring_compositions(ancestors.species.size(), allocator);
+	arena_vector<arena_vector<types::network_index_t>> species_ancestor_lookups(
+		ancestors.species.size(),
+		arena_vector<types::network_index_t>(allocator),
+		allocator
+	);
 
 	for (const auto& species_segment : ancestor_species_thread_segments) {
-		threads.emplace_back([&, species_segment]() {
+		auto& arena = worker_arena(threads.size());
+		threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::sampling, [&, species_segment]() {
 			calculate_species_offspring_composition_and_sample_ancestors(
+				arena,
 				ancestors.species,
 				ancestors.networks,
 				ancestor_fitness,
@@ -1049,7 +1096,7 @@ void trainer::evolve_into(
 				species_ancestor_lookups,
 				species_segment
 			);
-		});
+		}));
 	}
 
 	for (auto& thread : threads) {
@@ -1057,9 +1104,9 @@ void trainer::evolve_into(
 	}
 	threads.clear();
 
-	offspring.networks.resize(ancestors.networks.size());
+	const auto layout_begin = phase_recorder::clock_t::now();
 
-	// std::cout << "|-------------[ accumulate species compositions ]-------------|" << std::endl;
+	resize_partitioned(offspring.networks, ancestors.networks.size());
 
 	// Add all compositions together
 	types::population_composition_t offspring_composition{};
@@ -1072,11 +1119,21 @@ void trainer::evolve_into(
 		offspring_composition.crossover_count += species_offspring_composition.crossover_count;
 	}
 
-	std::cout << "add_conn_mutation_count: " << offspring_composition.add_conn_mutation_count << std::endl;
-	std::cout << "add_node_mutation_count: " << offspring_composition.add_node_mutation_count << std::endl;
-	std::cout << "conn_mutation_count: " << offspring_composition.conn_mutation_count << std::endl;
-	std::cout << "champion_count: " << offspring_composition.champion_count << std::endl;
-	std::cout << "crossover_count: " << offspring_composition.crossover_count << std::endl;
+	m_phase_recorder.stats().composition = offspring_composition;
+
+	if (m_execution_config.mode == execution_mode_t::species_parallel) {
+		m_phase_recorder.record_serial(layout_begin, phase_recorder::clock_t::now());
+		reproduce_species_parallel(
+			ancestors,
+			ancestor_fitness,
+			species_offspring_counts,
+			species_offspring_compositions,
+			species_ancestor_lookups,
+			offspring
+		);
+		speciate(ancestors, offspring);
+		return;
+	}
 
 	// Combine ancestor lookup
 	const auto directly_inherited_ancestor_count =
@@ -1085,45 +1142,71 @@ void trainer::evolve_into(
 
 	const auto ancestors_count = (directly_inherited_ancestor_count + offspring_composition.crossover_count * 2);
 
-	// std::cout << "|-------------[ Copy ancestors into one vector ]-------------|" << std::endl;
+	arena_vector<types::network_index_t> ancestor_lookup(ancestors_count, allocator);
 
-	debug_vector<types::network_index_t> ancestor_lookup(ancestors_count);
+	// Copy all indices into this continuous vector. The offsets of the species are prefix sums over
+	// their composition, so the species can be copied in parallel.
+	const auto species_range = types::species_range_t::from_index_count(0, ancestors.species.size());
+	arena_vector<types::network_index_t> species_direct_ancestor_offsets(ancestors.species.size(), allocator);
+	arena_vector<types::network_index_t> species_crossover_ancestor_offsets(ancestors.species.size(), allocator);
 
-	// Copy all indices into this continuous vector.
-	auto directly_inherited_ancestor_lookup_index = types::network_index_t{};
-	auto crossover_ancestor_indices_offset = directly_inherited_ancestor_count;
+	const auto species_direct_ancestor_count = [&](const types::species_index_t species_index) {
+		const auto& species_offspring_composition = species_offspring_compositions[species_index];
+		return species_offspring_composition.add_conn_mutation_count +
+		       species_offspring_composition.add_node_mutation_count +
+		       species_offspring_composition.conn_mutation_count + species_offspring_composition.champion_count;
+	};
 
-	// Has to be single threaded, because offset is only calculated while copying
-	for (std::size_t i{}; i != ancestors.species.size(); ++i) {
+	parallel_exclusive_scan(
+		species_range,
+		types::network_index_t{},
+		m_thread_count,
+		species_direct_ancestor_count,
+		[&](const types::species_index_t species_index, const types::network_index_t offset) {
+			species_direct_ancestor_offsets[species_index] = offset;
+		},
+		allocator
+	);
 
-		const auto& species_ancestor_lookup = species_ancestor_lookups[i];
-		const auto& species_offspring_composition = species_offspring_compositions[i];
+	parallel_exclusive_scan(
+		species_range,
+		directly_inherited_ancestor_count,
+		m_thread_count,
+		[&](const types::species_index_t species_index) {
+			return species_offspring_compositions[species_index].crossover_count *
+			       static_cast<types::network_index_t>(sizeof(types::parents_t) / sizeof(types::network_index_t));
+		},
+		[&](const types::species_index_t species_index, const types::network_index_t offset) {
+			species_crossover_ancestor_offsets[species_index] = offset;
+		},
+		allocator
+	);
 
-		const auto add_ancestors = [&](types::network_index_t& dst_index,
-		                               types::network_index_t& src_index,
-		                               const types::network_index_t count) {
-			const auto src_end = src_index + count;
-			while (src_index != src_end) {
-				ancestor_lookup[dst_index++] = species_ancestor_lookup[src_index++];
+	for (const auto species_segment : species_range.balanced_segments(m_thread_count)) {
+		threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::sampling, [&, species_segment]() {
+			for (const auto& species_index : species_segment.indices()) {
+				const auto& species_ancestor_lookup = species_ancestor_lookups[species_index];
+				const auto direct_ancestor_count = species_direct_ancestor_count(species_index);
+
+				// The directly inherited ancestors come first in the species lookup, the crossover parents after them.
+				std::copy(
+					species_ancestor_lookup.begin(),
+					species_ancestor_lookup.begin() + direct_ancestor_count,
+					ancestor_lookup.begin() + species_direct_ancestor_offsets[species_index]
+				);
+				std::copy(
+					species_ancestor_lookup.begin() + direct_ancestor_count,
+					species_ancestor_lookup.end(),
+					ancestor_lookup.begin() + species_crossover_ancestor_offsets[species_index]
+				);
 			}
-		};
-
-		auto species_indices_index = types::network_index_t{};
-
-		add_ancestors(
-			directly_inherited_ancestor_lookup_index,
-			species_indices_index,
-			species_offspring_composition.add_conn_mutation_count +
-				species_offspring_composition.add_node_mutation_count +
-				species_offspring_composition.conn_mutation_count + species_offspring_composition.champion_count
-		);
+		}));
+	}
 
-		add_ancestors(
-			crossover_ancestor_indices_offset,
-			species_indices_index,
-			species_offspring_composition.crossover_count * (sizeof(types::parents_t) / sizeof(types::network_index_t))
-		);
+	for (auto& thread : threads) {
+		thread.join();
 	}
+	threads.clear();
 
 	// Create spans to easier traverse the indices.
 	const auto add_conn_mutation_range = types::network_range_t::from_index_count(
@@ -1164,72 +1247,52 @@ void trainer::evolve_into(
 	);
 
 	// Calculate the exact number of all offspring connections.
+	// The connection ranges of every category are laid out back to back by a prefix sum over the network sizes.
+	const auto layout_offspring_connections = [&](const types::network_range_t& network_range,
+	                                              const types::node_index_t added_node_count,
+	                                              const std::size_t added_connection_count,
+	                                              const std::size_t connections_begin) {
+		const auto connections_end = parallel_exclusive_scan(
+			network_range,
+			connections_begin,
+			m_thread_count,
+			[&](const types::network_index_t network_index) {
+				const auto& ancestor_network = ancestors.networks[ancestor_lookup[network_index]];
+				return ancestor_network.connections.size() + added_connection_count;
+			},
+			[&](const types::network_index_t network_index, const std::size_t connection_offset) {
+				const auto& ancestor_network = ancestors.networks[ancestor_lookup[network_index]];
+				auto& offspring_network = offspring.networks[network_index];
+
+				offspring_network.hidden_node_count = ancestor_network.hidden_node_count + added_node_count;
+
+				auto& offspring_connections = offspring_network.connections;
+				offspring_connections.begin() = connection_offset;
+				offspring_connections.resize(ancestor_network.connections.size() + added_connection_count);
+			},
+			allocator
+		);
+		return connections_end - connections_begin;
+	};
+
 	types::population_composition_t connection_composition{};
 	auto offspring_connection_count = std::size_t{};
 
-	// std::cout << "|-------------[ count add_conn_mutation connections ]-------------|" << std::endl;
-
-	// Calculate number of add connection mutation networks
-	for (const auto& network_index : add_conn_mutation_range.indices()) {
-
-		const auto& ancestor_network = ancestors.networks[ancestor_lookup[network_index]];
-		auto& offspring_network = offspring.networks[network_index];
-
-		offspring_network.hidden_node_count = ancestor_network.hidden_node_count;
-
-		auto& offspring_connections = offspring_network.connections;
-		offspring_connections.begin() = offspring_connection_count + connection_composition.add_conn_mutation_count;
-		offspring_connections.resize(ancestor_network.connections.size() + 1); // the inserted connection
-
-		connection_composition.add_conn_mutation_count += offspring_connections.size();
-	}
+	// Add connection mutation networks get the inserted connection.
+	connection_composition.add_conn_mutation_count =
+		layout_offspring_connections(add_conn_mutation_range, 0, 1, offspring_connection_count);
 	offspring_connection_count += connection_composition.add_conn_mutation_count;
 
-	// std::cout << "|-------------[ count add_node_mutation connections ]-------------|" << std::endl;
-
-	// Calculate number of add node mutation networks
-	for (const auto& network_index : add_node_mutation_range.indices()) {
-
-		const auto& ancestor_network = ancestors.networks[ancestor_lookup[network_index]];
-		auto& offspring_network = offspring.networks[network_index];
-
-		offspring_network.hidden_node_count = ancestor_network.hidden_node_count + 1;
-
-		auto& offspring_connections = offspring_network.connections;
-		offspring_connections.begin() = offspring_connection_count + connection_composition.add_node_mutation_count;
-		offspring_connections.resize(
-			ancestor_network.connections.size() + 2
-		); // the two extra connection to and from the node
-
-		connection_composition.add_node_mutation_count += offspring_connections.size();
-	}
-
+	// Add node mutation networks get the new node and the two extra connections to and from it.
+	connection_composition.add_node_mutation_count =
+		layout_offspring_connections(add_node_mutation_range, 1, 2, offspring_connection_count);
 	offspring_connection_count += connection_composition.add_node_mutation_count;
 
-	// std::cout << "|-------------[ count topologically_unchanged connections ]-------------|" << std::endl;
-
-	// Calculate number of topologically unchanged networks
-	for (const auto& network_index : topologically_unchanged_range.indices()) {
-
-		const auto& ancestor_network = ancestors.networks[ancestor_lookup[network_index]];
-		auto& offspring_network = offspring.networks[network_index];
-
-		offspring_network.hidden_node_count = ancestor_network.hidden_node_count;
-
-		auto& offspring_connections = offspring_network.connections;
-		offspring_connections.begin() = offspring_connection_count + connection_composition.conn_mutation_count;
-		offspring_connections.resize(ancestor_network.connections.size()); // same topology -> no extra connections
-
-		connection_composition.conn_mutation_count += offspring_connections.size();
-	}
-
+	// Topologically unchanged networks keep the connection count of their ancestor.
+	connection_composition.conn_mutation_count =
+		layout_offspring_connections(topologically_unchanged_range, 0, 0, offspring_connection_count);
 	offspring_connection_count += connection_composition.conn_mutation_count;
 
-	// std::cout << "|-------------[ count crossover connections ]-------------|" << std::endl;
-
-	// Calculate number of crossover connections
-	debug_vector<std::random_device::result_type> crossover_seeds(offspring_composition.crossover_count);
-
 	const auto crossover_parent_lookup = debug_span(
 		reinterpret_cast<const types::parents_t*>(&ancestor_lookup[crossover_range.begin()]),
 		crossover_range.size()
@@ -1239,38 +1302,23 @@ void trainer::evolve_into(
 		ancestor_lookup.cend().base()
 	);
 
-	std::random_device rd{};
-	std::default_random_engine deterministic_engine{ 0 }; // This initial seed is just a placeholder and never used.
-	auto parents_connection_survival_distrib = std::uniform_int_distribution<std::uint8_t>(false, true);
-
-	for (types::network_index_t i{}; i != crossover_range.size(); ++i) {
-
-		deterministic_engine.seed(crossover_seeds[i] = rd());
-
-		parents_connection_survival_distrib.reset();
-
-		auto& offspring_network = offspring.networks[crossover_range.begin() + i];
-
-		auto& offspring_connections = offspring_network.connections;
-		offspring_connections.begin() = offspring_connection_count + connection_composition.crossover_count;
-		offspring_connections.resize(crossover_offspring_conn_count(
-			deterministic_engine,
-			parents_connection_survival_distrib,
-			ancestors.networks,
-			ancestors.connection_infos,
-			ancestor_fitness,
-			crossover_parent_lookup[i]
-		));
-
-		connection_composition.crossover_count += offspring_connections.size();
-	}
-
-	offspring_connection_count += connection_composition.crossover_count;
+	// A crossover offspring can't have more connections than both parents together. The crossovers are compacted
+	// behind the other networks once their sizes are known, until then only this upper bound is reserved.
+	const auto crossover_connections_begin = offspring_connection_count;
+	auto crossover_parent_connection_count = std::size_t{};
+	for (const auto& parent_indices : crossover_parent_lookup) {
+		for (const auto& parent_index : parent_indices) {
+			crossover_parent_connection_count += ancestors.networks[parent_index].connections.size();
+		}
+	}
+	offspring_connection_count += crossover_parent_connection_count;
 
 	// Finally allocate connection arrays
-	offspring.connections.resize(offspring_connection_count);
-	offspring.connection_weights.resize(offspring_connection_count);
-	offspring.connection_infos.resize(offspring_connection_count);
+	resize_partitioned(offspring.connections, offspring_connection_count);
+	resize_partitioned(offspring.connection_weights, offspring_connection_count);
+	resize_partitioned(offspring.connection_infos, offspring_connection_count);
+
+	m_phase_recorder.record_serial(layout_begin, phase_recorder::clock_t::now());
 
 	const auto calc_portion = [](const std::size_t count, const double portion) {
 		return std::max(static_cast<std::size_t>(std::round(portion * static_cast<double>(count))), 1ul);
@@ -1305,13 +1353,12 @@ void trainer::evolve_into(
 		sizeof(types::connection_info_t)
 	);
 
-	// std::cout << "|-------------[ copying directly inherited connections ]-------------|" << std::endl;
-
 	// Copy old connections over from all directly inherited networks.
 	if (not directly_inherited_range.empty()) {
 		for (const auto directly_inherited_segment :
 		     directly_inherited_range.balanced_segments(connection_copy_thread_count)) {
-			threads.emplace_back([&, directly_inherited_segment]() {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::copying, [&, directly_inherited_segment]() {
+				place_worker(directly_inherited_segment.begin());
 				copy_connection_data<types::connection_t>(
 					ancestor_lookup,
 					ancestors.networks,
@@ -1320,12 +1367,13 @@ void trainer::evolve_into(
 					offspring.connections,
 					directly_inherited_segment
 				);
-			});
+			}));
 		}
 
 		for (const auto directly_inherited_segment :
 		     directly_inherited_range.balanced_segments(connection_weight_copy_thread_count)) {
-			threads.emplace_back([&, directly_inherited_segment]() {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::copying, [&, directly_inherited_segment]() {
+				place_worker(directly_inherited_segment.begin());
 				copy_connection_data<types::connection_weight_t>(
 					ancestor_lookup,
 					ancestors.networks,
@@ -1334,12 +1382,13 @@ void trainer::evolve_into(
 					offspring.connection_weights,
 					directly_inherited_segment
 				);
-			});
+			}));
 		}
 
 		for (const auto directly_inherited_segment :
 		     directly_inherited_range.balanced_segments(connection_info_copy_thread_count)) {
-			threads.emplace_back([&, directly_inherited_segment]() {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::copying, [&, directly_inherited_segment]() {
+				place_worker(directly_inherited_segment.begin());
 				copy_connection_data<types::connection_info_t>(
 					ancestor_lookup,
 					ancestors.networks,
@@ -1348,57 +1397,64 @@ void trainer::evolve_into(
 					offspring.connection_infos,
 					directly_inherited_segment
 				);
-			});
+			}));
 		}
 	}
 
+	// Every copied array has its own threads, which can be more than the mutation threads.
+	const auto copy_thread_count = threads.size();
+
 	// Crossover copies the connections itself, so it can be started before the mutation copy finishes
 	const auto crossover_thread_count = std::max(1u, m_thread_count - mutation_tread_range.size());
 
-	// std::cout << "|-------------[ starting crossocer ]-------------|" << std::endl;
+	const auto crossover_segments = crossover_range.balanced_segments(crossover_thread_count);
+	m_crossover_stagings.resize(std::max(m_crossover_stagings.size(), std::size_t{ crossover_thread_count }));
 
 	if (not crossover_range.empty()) {
-		for (const auto& crossover_segment : crossover_range.balanced_segments(crossover_thread_count)) {
-			threads.emplace_back([&, crossover_segment]() {
+		for (std::size_t i{}; i != crossover_thread_count; ++i) {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::crossover, [&, i]() {
+				const auto crossover_segment = crossover_segments[i];
+				place_worker(crossover_segment.begin());
+				auto& staging = m_crossover_stagings[i];
+				staging.connections.clear();
+				staging.connection_weights.clear();
+				staging.connection_infos.clear();
 				create_crossovers(
+					m_generation_count,
 					ancestors.networks,
 					ancestors.connections,
 					ancestors.connection_weights,
 					ancestors.connection_infos,
 					ancestor_fitness,
 					crossover_parent_lookup,
-					crossover_seeds,
 					offspring.networks,
-					offspring.connections,
-					offspring.connection_weights,
-					offspring.connection_infos,
+					staging,
 					crossover_segment.begin() - crossover_range.begin(),
 					crossover_segment
 				);
-			});
+			}));
 		}
 	}
 
 	// Wait for mutation copy threads to terminate
-	const auto mutation_treads = mutation_tread_range.span(threads);
-	for (auto& mutation_tread : mutation_treads) {
-		mutation_tread.join();
+	for (auto& copy_thread : std::span(threads).first(copy_thread_count)) {
+		copy_thread.join();
 	}
-	threads.erase(threads.cbegin(), threads.cbegin() + mutation_treads.size());
-
-	// std::cout << "|-------------[ copying directly inherited connections done ]-------------|" << std::endl;
+	threads.erase(threads.cbegin(), threads.cbegin() + static_cast<std::ptrdiff_t>(copy_thread_count));
 
 	// Start the mutation threads.
-	const auto add_conn_mutation_thread_count = calc_portion(mutation_treads.size(), 0.6);
-	const auto add_node_mutation_thread_count = calc_portion(mutation_treads.size(), 0.4);
+	const auto add_conn_mutation_thread_count = calc_portion(mutation_tread_range.size(), 0.6);
+	const auto add_node_mutation_thread_count = calc_portion(mutation_tread_range.size(), 0.4);
 
-	// std::cout << "|-------------[ apply_add_conn_mutations ]-------------|" << std::endl;
+	const auto add_conn_mutation_segments = add_conn_mutation_range.balanced_segments(add_conn_mutation_thread_count);
+	m_connection_samplers.resize(std::max(m_connection_samplers.size(), add_conn_mutation_thread_count));
 
 	if (not add_conn_mutation_range.empty()) {
-		for (const auto add_conn_mutation_segment :
-		     add_conn_mutation_range.balanced_segments(add_conn_mutation_thread_count)) {
-			threads.emplace_back([&, add_conn_mutation_segment]() {
+		for (std::size_t i{}; i != add_conn_mutation_thread_count; ++i) {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::mutation, [&, i]() {
+				place_worker(add_conn_mutation_segments[i].begin());
 				apply_add_conn_mutations(
+					m_generation_count,
 					ancestors.networks,
 					ancestors.connections,
 					ancestor_lookup,
@@ -1406,19 +1462,20 @@ void trainer::evolve_into(
 					offspring.connections,
 					offspring.connection_weights,
 					offspring.connection_infos,
-					add_conn_mutation_segment
+					m_connection_samplers[i],
+					add_conn_mutation_segments[i]
 				);
-			});
+			}));
 		}
 	}
 
-	// std::cout << "|-------------[ apply_add_node_mutations ]-------------|" << std::endl;
-
 	if (not add_node_mutation_range.empty()) {
 		for (const auto add_node_mutation_segment :
 		     add_node_mutation_range.balanced_segments(add_node_mutation_thread_count)) {
-			threads.emplace_back([&, add_node_mutation_segment]() {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::mutation, [&, add_node_mutation_segment]() {
+				place_worker(add_node_mutation_segment.begin());
 				apply_add_node_mutations(
+					m_generation_count,
 					ancestors.networks,
 					ancestors.connections,
 					ancestors.connection_weights,
@@ -1429,7 +1486,7 @@ void trainer::evolve_into(
 					offspring.connection_infos,
 					add_node_mutation_segment
 				);
-			});
+			}));
 		}
 	}
 
@@ -1439,20 +1496,71 @@ void trainer::evolve_into(
 	}
 	threads.clear();
 
+	// An exclusive prefix sum over the staged connection counts gives every staging buffer its final position,
+	// so all of them can be compacted in parallel.
+	if (not crossover_range.empty()) {
+		auto staging_offset = crossover_connections_begin;
+		for (std::size_t i{}; i != crossover_thread_count; ++i) {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::crossover, [&, i, staging_offset]() {
+				place_worker(crossover_segments[i].begin());
+				compact_crossovers(
+					m_crossover_stagings[i],
+					staging_offset,
+					offspring.networks,
+					offspring.connections,
+					offspring.connection_weights,
+					offspring.connection_infos,
+					crossover_segments[i]
+				);
+			}));
+			staging_offset += m_crossover_stagings[i].connections.size();
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		threads.clear();
+
+		connection_composition.crossover_count = staging_offset - crossover_connections_begin;
+
+		// Only drops the unused part of the upper bound, so nothing is reallocated.
+		offspring_connection_count = staging_offset;
+		offspring.connections.resize(offspring_connection_count);
+		offspring.connection_weights.resize(offspring_connection_count);
+		offspring.connection_infos.resize(offspring_connection_count);
+	}
+
+	const auto assign_innovations_begin = phase_recorder::clock_t::now();
+	assign_innovation_numbers(
+		ancestors.networks,
+		ancestor_lookup,
+		offspring.networks,
+		offspring.connections,
+		offspring.connection_infos,
+		types::network_range_t::from_begin_end(add_conn_mutation_range.begin(), add_node_mutation_range.end())
+	);
+	m_phase_recorder.record_serial(assign_innovations_begin, phase_recorder::clock_t::now());
+
 	// Apply simple connection weight mutations
 
+	m_phase_recorder.stats().lock_stats.connection_lookup = m_conn_lookup.lock_stats();
+	m_conn_lookup.reset_lock_stats();
+
 	// Only current gen innovations need to be taken into account
 	m_conn_lookup.clear();
 	const auto all_conn_mutation_thread_count = calc_portion(m_thread_count, 0.2);
 
-	// std::cout << "|-------------[ mutate_connections ]-------------|" << std::endl;
-
 	if (not conn_mutation_range.empty()) {
 		for (const auto& conn_mutation_segment :
 		     conn_mutation_range.balanced_segments(all_conn_mutation_thread_count)) {
-			threads.emplace_back([&, conn_mutation_segment]() {
-				mutate_all_connections(offspring.networks, offspring.connection_weights, conn_mutation_segment);
-			});
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::mutation, [&, conn_mutation_segment]() {
+				place_worker(conn_mutation_segment.begin());
+				mutate_all_connections(
+					m_generation_count,
+					offspring.networks,
+					offspring.connection_weights,
+					conn_mutation_segment
+				);
+			}));
 		}
 	}
 
@@ -1469,9 +1577,15 @@ void trainer::evolve_into(
 
 		for (const auto& conn_mutation_segment :
 		     add_conn_mutation_range.balanced_segments(add_conn_weight_mutation_thread_count)) {
-			threads.emplace_back([&, conn_mutation_segment]() {
-				mutate_some_connections(offspring.networks, offspring.connection_weights, conn_mutation_segment);
-			});
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::mutation, [&, conn_mutation_segment]() {
+				place_worker(conn_mutation_segment.begin());
+				mutate_some_connections(
+					m_generation_count,
+					offspring.networks,
+					offspring.connection_weights,
+					conn_mutation_segment
+				);
+			}));
 		}
 	}
 
@@ -1484,9 +1598,15 @@ void trainer::evolve_into(
 
 		for (const auto& conn_mutation_segment :
 		     add_node_mutation_range.balanced_segments(add_node_weight_mutation_thread_count)) {
-			threads.emplace_back([&, conn_mutation_segment]() {
-				mutate_some_connections(offspring.networks, offspring.connection_weights, add_node_mutation_range);
-			});
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::mutation, [&, conn_mutation_segment]() {
+				place_worker(conn_mutation_segment.begin());
+				mutate_some_connections(
+					m_generation_count,
+					offspring.networks,
+					offspring.connection_weights,
+					conn_mutation_segment
+				);
+			}));
 		}
 	}
 
@@ -1498,10 +1618,16 @@ void trainer::evolve_into(
 		);
 
 		for (const auto& conn_mutation_segment :
-		     add_conn_mutation_range.balanced_segments(crossover_weight_mutation_thread_count)) {
-			threads.emplace_back([&, conn_mutation_segment]() {
-				mutate_some_connections(offspring.networks, offspring.connection_weights, conn_mutation_segment);
-			});
+		     crossover_range.balanced_segments(crossover_weight_mutation_thread_count)) {
+			threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::mutation, [&, conn_mutation_segment]() {
+				place_worker(conn_mutation_segment.begin());
+				mutate_some_connections(
+					m_generation_count,
+					offspring.networks,
+					offspring.connection_weights,
+					conn_mutation_segment
+				);
+			}));
 		}
 	}
 
@@ -1510,8 +1636,6 @@ void trainer::evolve_into(
 	}
 	threads.clear();
 
-	m_species_sorter.clear();
-
 	for (const auto& network : add_conn_mutation_range.cspan(offspring.networks)) {
 		for (const auto& [from, to] : network.connections.cspan(offspring.connections)) {
 			assert(from != to);
@@ -1598,29 +1722,61 @@ void trainer::evolve_into(
 		}
 	}
 
-	// std::cout << "|-------------[ sort_into_buckets ]-------------|" << std::endl;
+	speciate(ancestors, offspring);
 
-	const auto offspring_network_range = types::network_range_t::from_range(offspring.networks);
-	for (const auto& species_segment : offspring_network_range.balanced_segments(m_thread_count)) {
-		threads.emplace_back([&, species_segment]() {
-			m_species_sorter.sort_into_buckets(
-				m_evolution_config.difference_config,
-				offspring.connection_weights,
-				offspring.connection_infos,
-				offspring.networks,
-				ancestors.networks.size() / ancestors.species.size(),
-				species_segment
-			);
-		});
-	}
+	// Item counts and estimated memory traffic of all phases.
+	auto& stats = m_phase_recorder.stats();
 
-	for (auto& thread : threads) {
-		thread.join();
-	}
+	const auto set_phase_counts =
+		[&stats](const trainer_phase_t phase, const std::uint64_t items, const std::uint64_t bytes) {
+			stats.phase(phase).item_count = items;
+			stats.phase(phase).bytes_touched = bytes;
+		};
 
-	// std::cout << "|-------------[ assign_species_and_sorted_networks ]-------------|" << std::endl;
+	const auto directly_inherited_connection_count =
+		(connection_composition.add_conn_mutation_count + connection_composition.add_node_mutation_count +
+	     connection_composition.conn_mutation_count);
 
-	m_species_sorter.assign_species_and_sorted_networks(offspring.species, offspring.networks);
+	const auto weight_mutated_connection_count = directly_inherited_connection_count +
+		connection_composition.crossover_count;
+
+	set_phase_counts(
+		trainer_phase_t::calc_species_fitness,
+		ancestors.species.size(),
+		ancestor_fitness.size_bytes() + ancestors.species.size() * (sizeof(types::species_t) + sizeof(float))
+	);
+	set_phase_counts(
+		trainer_phase_t::divide_offspring,
+		ancestors.species.size(),
+		ancestors.species.size() * (sizeof(float) + sizeof(types::network_index_t))
+	);
+	set_phase_counts(
+		trainer_phase_t::sampling,
+		ancestors_count,
+		2 * ancestors_count * sizeof(types::network_index_t) + offspring.networks.size() * sizeof(types::network_t)
+	);
+	set_phase_counts(
+		trainer_phase_t::copying,
+		directly_inherited_connection_count,
+		(offspring_connection_count + 2 * directly_inherited_connection_count) * bytes_per_connection
+	);
+	// Both parents are traversed once, the offspring are written to the staging buffers and copied from there.
+	set_phase_counts(
+		trainer_phase_t::crossover,
+		crossover_range.size(),
+		(crossover_parent_connection_count + 3 * connection_composition.crossover_count) * bytes_per_connection
+	);
+	set_phase_counts(
+		trainer_phase_t::mutation,
+		add_conn_mutation_range.size() + add_node_mutation_range.size() + total_some_conn_mutations,
+		2 * weight_mutated_connection_count * sizeof(types::connection_weight_t)
+	);
+	set_phase_counts(
+		trainer_phase_t::speciation,
+		offspring.networks.size(),
+		offspring_connection_count * (sizeof(types::connection_weight_t) + sizeof(types::connection_info_t)) +
+			2 * offspring.networks.size() * sizeof(types::network_t)
+	);
 
 	for (const auto& network : add_conn_mutation_range.cspan(offspring.networks)) {
 		for (const auto& [from, to] : network.connections.cspan(offspring.connections)) {
@@ -1639,6 +1795,381 @@ void trainer::evolve_into(
 	}
 }
 
+void trainer::reproduce_species_parallel(
+	const types::population_t& ancestors,
+	debug_span<const types::fitness_t> ancestor_fitness,
+	debug_span<const types::network_index_t> species_offspring_counts,
+	debug_span<const types::population_composition_t> species_offspring_compositions,
+	debug_span<const arena_vector<types::network_index_t>> species_ancestor_lookups,
+	types::population_t& offspring
+) {
+	const auto allocator = arena_allocator<std::byte>(m_arena);
+	const auto species_count = static_cast<types::species_index_t>(species_offspring_counts.size());
+
+	// Every species reproduces into its own continuous slice of the offspring networks.
+	const auto species_range = types::species_range_t::from_index_count(0, species_count);
+	arena_vector<types::network_range_t> species_network_ranges(species_count, allocator);
+	parallel_exclusive_scan(
+		species_range,
+		types::network_index_t{},
+		m_thread_count,
+		[&](const types::species_index_t species_index) { return species_offspring_counts[species_index]; },
+		[&](const types::species_index_t species_index, const types::network_index_t network_offset) {
+			species_network_ranges[species_index] = types::network_range_t::from_index_count(
+				network_offset,
+				species_offspring_counts[species_index]
+			);
+		},
+		allocator
+	);
+
+	// The directly inherited networks of all species share one lookup, indexed by offspring network index.
+	arena_vector<types::network_index_t> ancestor_lookup(offspring.networks.size(), allocator);
+
+	struct species_staging_t {
+		std::uint32_t worker_index;
+		types::conn_range_t connections;
+	};
+	arena_vector<species_staging_t> species_stagings(species_count, allocator);
+
+	m_crossover_stagings.resize(std::max(m_crossover_stagings.size(), std::size_t{ m_thread_count }));
+	m_connection_samplers.resize(std::max(m_connection_samplers.size(), std::size_t{ m_thread_count }));
+
+	arena_vector<std::thread> threads(allocator);
+	threads.reserve(m_thread_count);
+
+	// The workers take the next species whenever they are done, so big species don't hold up the small ones.
+	auto next_species_index = std::atomic<types::species_index_t>{};
+
+	for (std::uint32_t worker_index{}; worker_index != m_thread_count; ++worker_index) {
+		threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::reproduction, [&, worker_index]() {
+			// The species are taken dynamically, so the workers are only spread evenly over the nodes.
+			place_worker(static_cast<types::network_index_t>(worker_index * m_population_size / m_thread_count));
+			auto& staging = m_crossover_stagings[worker_index];
+			staging.connections.clear();
+			staging.connection_weights.clear();
+			staging.connection_infos.clear();
+
+			for (auto species_index = next_species_index++; species_index < species_count;
+			     species_index = next_species_index++) {
+				const auto staging_begin = staging.connections.size();
+				reproduce_species(
+					ancestors,
+					ancestor_fitness,
+					species_offspring_compositions[species_index],
+					species_ancestor_lookups[species_index],
+					ancestor_lookup,
+					offspring.networks,
+					staging,
+					m_connection_samplers[worker_index],
+					species_network_ranges[species_index]
+				);
+				species_stagings[species_index] = {
+					.worker_index = worker_index,
+					.connections = types::conn_range_t::from_begin_end(staging_begin, staging.connections.size())
+				};
+			}
+		}));
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+
+	// The species are placed in order, so the layout doesn't depend on which worker created them.
+	arena_vector<types::conn_index_t> species_connection_offsets(species_count, allocator);
+	const auto offspring_connection_count = parallel_exclusive_scan(
+		species_range,
+		types::conn_index_t{},
+		m_thread_count,
+		[&](const types::species_index_t species_index) { return species_stagings[species_index].connections.size(); },
+		[&](const types::species_index_t species_index, const types::conn_index_t connection_offset) {
+			species_connection_offsets[species_index] = connection_offset;
+		},
+		allocator
+	);
+
+	resize_partitioned(offspring.connections, offspring_connection_count);
+	resize_partitioned(offspring.connection_weights, offspring_connection_count);
+	resize_partitioned(offspring.connection_infos, offspring_connection_count);
+
+	// The weights are mutated at their final position, so the mutation streams are independent of the workers.
+	next_species_index = 0;
+	for (std::uint32_t worker_index{}; worker_index != m_thread_count; ++worker_index) {
+		threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::reproduction, [&, worker_index]() {
+			place_worker(static_cast<types::network_index_t>(worker_index * m_population_size / m_thread_count));
+			for (auto species_index = next_species_index++; species_index < species_count;
+			     species_index = next_species_index++) {
+				const auto& [staging_worker_index, staged_connections] = species_stagings[species_index];
+				const auto& staging = m_crossover_stagings[staging_worker_index];
+				const auto connection_offset = species_connection_offsets[species_index];
+				const auto& species_network_range = species_network_ranges[species_index];
+
+				for (auto& network : species_network_range.span(offspring.networks)) {
+					network.connections = types::conn_range_t::from_index_count(
+						connection_offset + network.connections.begin() - staged_connections.begin(),
+						network.connections.size()
+					);
+				}
+
+				const auto copy_staging = [&](const auto& staged, auto& destination) {
+					const auto staged_data = staged_connections.cspan(staged);
+					std::copy(staged_data.begin(), staged_data.end(), destination.begin() + connection_offset);
+				};
+				copy_staging(staging.connections, offspring.connections);
+				copy_staging(staging.connection_weights, offspring.connection_weights);
+				copy_staging(staging.connection_infos, offspring.connection_infos);
+
+				const auto& composition = species_offspring_compositions[species_index];
+				const auto add_conn_mutation_range = types::network_range_t::from_index_count(
+					species_network_range.begin(),
+					composition.add_conn_mutation_count
+				);
+				const auto add_node_mutation_range = types::network_range_t::from_index_count(
+					add_conn_mutation_range.end(),
+					composition.add_node_mutation_count
+				);
+				const auto conn_mutation_range = types::network_range_t::from_index_count(
+					add_node_mutation_range.end(),
+					composition.conn_mutation_count
+				);
+				const auto crossover_range = types::network_range_t::from_begin_end(
+					species_network_range.end() - composition.crossover_count,
+					species_network_range.end()
+				);
+
+				mutate_all_connections(
+					m_generation_count,
+					offspring.networks,
+					offspring.connection_weights,
+					conn_mutation_range
+				);
+				for (const auto& range : { add_conn_mutation_range, add_node_mutation_range, crossover_range }) {
+					mutate_some_connections(
+						m_generation_count,
+						offspring.networks,
+						offspring.connection_weights,
+						range
+					);
+				}
+			}
+		}));
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+
+	// Innovation numbers are handed out in network order, like in the phased mode.
+	const auto assign_innovations_begin = phase_recorder::clock_t::now();
+	for (types::species_index_t i{}; i != species_count; ++i) {
+		const auto& composition = species_offspring_compositions[i];
+		assign_innovation_numbers(
+			ancestors.networks,
+			ancestor_lookup,
+			offspring.networks,
+			offspring.connections,
+			offspring.connection_infos,
+			types::network_range_t::from_index_count(
+				species_network_ranges[i].begin(),
+				composition.add_conn_mutation_count + composition.add_node_mutation_count
+			)
+		);
+	}
+	m_phase_recorder.record_serial(assign_innovations_begin, phase_recorder::clock_t::now());
+
+	auto& stats = m_phase_recorder.stats();
+	stats.lock_stats.connection_lookup = m_conn_lookup.lock_stats();
+	m_conn_lookup.reset_lock_stats();
+	m_conn_lookup.clear();
+
+	// The staged connections are copied once more than in the phased mode.
+	const auto bytes_per_connection =
+		(sizeof(types::connection_t) + sizeof(types::connection_weight_t) + sizeof(types::connection_info_t));
+	stats.phase(trainer_phase_t::reproduction).item_count = offspring.networks.size();
+	stats.phase(trainer_phase_t::reproduction).bytes_touched = 4 * offspring_connection_count * bytes_per_connection;
+}
+
+void trainer::reproduce_species(
+	const types::population_t& ancestors,
+	debug_span<const types::fitness_t> ancestor_fitness,
+	const types::population_composition_t& species_offspring_composition,
+	debug_span<const types::network_index_t> species_ancestor_lookup,
+	debug_span<types::network_index_t> ancestor_lookup,
+	debug_span<types::network_t> offspring_networks,
+	crossover_staging_t& staging,
+	connection_sampler& sampler,
+	const types::network_range_t& species_network_range
+) {
+	// The offspring of a species are ordered like the offspring of all species in the phased mode.
+	const auto add_conn_mutation_range = types::network_range_t::from_index_count(
+		species_network_range.begin(),
+		species_offspring_composition.add_conn_mutation_count
+	);
+	const auto add_node_mutation_range = types::network_range_t::from_index_count(
+		add_conn_mutation_range.end(),
+		species_offspring_composition.add_node_mutation_count
+	);
+	const auto directly_inherited_range = types::network_range_t::from_begin_end(
+		species_network_range.begin(),
+		species_network_range.end() - species_offspring_composition.crossover_count
+	);
+	const auto crossover_range = types::network_range_t::from_begin_end(
+		directly_inherited_range.end(),
+		species_network_range.end()
+	);
+
+	for (const auto& network_index : directly_inherited_range.indices()) {
+		const auto ancestor_index = species_ancestor_lookup[network_index - species_network_range.begin()];
+		ancestor_lookup[network_index] = ancestor_index;
+
+		const auto& ancestor_network = ancestors.networks[ancestor_index];
+		auto& offspring_network = offspring_networks[network_index];
+
+		// Room for the connection or the node with its two connections that the mutations add.
+		auto added_connection_count = types::conn_index_t{};
+		offspring_network.hidden_node_count = ancestor_network.hidden_node_count;
+		if (add_conn_mutation_range.contains(network_index)) {
+			added_connection_count = 1;
+		} else if (add_node_mutation_range.contains(network_index)) {
+			added_connection_count = 2;
+			++offspring_network.hidden_node_count;
+		}
+
+		offspring_network.connections = types::conn_range_t::from_index_count(
+			staging.connections.size(),
+			ancestor_network.connections.size() + added_connection_count
+		);
+
+		const auto stage_connection_data = [&](const auto& ancestor_data, auto& staged_data) {
+			const auto data = ancestor_network.connections.cspan(ancestor_data);
+			staged_data.insert(staged_data.end(), data.begin(), data.end());
+			staged_data.resize(staged_data.size() + added_connection_count);
+		};
+		stage_connection_data(ancestors.connections, staging.connections);
+		stage_connection_data(ancestors.connection_weights, staging.connection_weights);
+		stage_connection_data(ancestors.connection_infos, staging.connection_infos);
+	}
+
+	const auto parents_lookup = debug_span(
+		reinterpret_cast<const types::parents_t*>(species_ancestor_lookup.data() + directly_inherited_range.size()),
+		crossover_range.size()
+	);
+
+	create_crossovers(
+		m_generation_count,
+		ancestors.networks,
+		ancestors.connections,
+		ancestors.connection_weights,
+		ancestors.connection_infos,
+		ancestor_fitness,
+		parents_lookup,
+		offspring_networks,
+		staging,
+		0,
+		crossover_range
+	);
+
+	apply_add_conn_mutations(
+		m_generation_count,
+		ancestors.networks,
+		ancestors.connections,
+		ancestor_lookup,
+		offspring_networks,
+		staging.connections,
+		staging.connection_weights,
+		staging.connection_infos,
+		sampler,
+		add_conn_mutation_range
+	);
+
+	apply_add_node_mutations(
+		m_generation_count,
+		ancestors.networks,
+		ancestors.connections,
+		ancestors.connection_weights,
+		ancestor_lookup,
+		offspring_networks,
+		staging.connections,
+		staging.connection_weights,
+		staging.connection_infos,
+		add_node_mutation_range
+	);
+}
+
+void trainer::speciate(const types::population_t& ancestors, types::population_t& offspring) {
+	arena_vector<std::thread> threads{ arena_allocator<std::thread>(m_arena) };
+	threads.reserve(m_thread_count);
+
+	const auto& difference_config = m_evolution_config.difference_config;
+
+	// The candidates are searched in chunks of a fixed size, so the species don't depend on the thread count.
+	const auto chunk_count = m_species_sorter.clear(offspring.networks.size());
+	const auto chunk_range = types::network_range_t::from_index_count(0, chunk_count);
+	for (const auto& chunk_segment : chunk_range.balanced_segments(m_thread_count)) {
+		threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::speciation, [&, chunk_segment]() {
+			for (const auto& chunk_index : chunk_segment.indices()) {
+				m_species_sorter.find_candidates(
+					difference_config,
+					offspring.connection_weights,
+					offspring.connection_infos,
+					offspring.networks,
+					chunk_index
+				);
+			}
+		}));
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+
+	const auto pick_representatives_begin = phase_recorder::clock_t::now();
+	m_species_sorter.pick_representatives(
+		difference_config,
+		offspring.connection_weights,
+		offspring.connection_infos,
+		offspring.networks,
+		ancestors.networks.size() / ancestors.species.size()
+	);
+	m_phase_recorder.record_serial(pick_representatives_begin, phase_recorder::clock_t::now());
+
+	const auto offspring_network_range = types::network_range_t::from_range(offspring.networks);
+	for (const auto& species_segment : offspring_network_range.balanced_segments(m_thread_count)) {
+		threads.emplace_back(m_phase_recorder.timed(trainer_phase_t::speciation, [&, species_segment]() {
+			m_species_sorter.sort_into_buckets(
+				difference_config,
+				offspring.connection_weights,
+				offspring.connection_infos,
+				offspring.networks,
+				species_segment
+			);
+		}));
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	const auto assign_species_begin = phase_recorder::clock_t::now();
+	m_species_sorter.assign_species_and_sorted_networks(
+		difference_config,
+		offspring.connection_weights,
+		offspring.connection_infos,
+		offspring.species,
+		offspring.networks
+	);
+	m_phase_recorder.record_serial(assign_species_begin, phase_recorder::clock_t::now());
+
+	auto& stats = m_phase_recorder.stats();
+	stats.species_count = offspring.species.size();
+	stats.lock_stats.species_lookup = m_species_sorter.lookup_lock_stats();
+	stats.lock_stats.species_buckets = m_species_sorter.bucket_lock_stats();
+}
+
 void trainer::update_inference_network_group(inference::types::network_group_t& network_group) {
 
 	auto& current_generation = m_populations[m_current_generation_index];
@@ -1650,11 +2181,11 @@ void trainer::update_inference_network_group(inference::types::network_group_t&
 		eval_and_output_map_node_count += network.hidden_node_count;
 	}
 
-	network_group.incoming_connection_counts_and_node_lookups.resize(eval_and_output_map_node_count);
-	network_group.connections.resize(current_generation.connections.size());
-	network_group.networks.resize(current_generation.networks.size());
+	resize_partitioned(network_group.incoming_connection_counts_and_node_lookups, eval_and_output_map_node_count);
+	resize_partitioned(network_group.connections, current_generation.connections.size());
+	resize_partitioned(network_group.networks, current_generation.networks.size());
 
-	debug_vector<std::thread> threads;
+	arena_vector<std::thread> threads{ arena_allocator<std::thread>(m_arena) };
 	threads.reserve(m_thread_count);
 
 	const auto avg_conns_per_section = network_group.connections.size() / m_thread_count;
@@ -1678,17 +2209,22 @@ void trainer::update_inference_network_group(inference::types::network_group_t&
 
 			assert(node_section.end() <= network_group.incoming_connection_counts_and_node_lookups.size());
 
-			threads.emplace_back(
-				[this, &current_generation, &network_group, network_section, node_section, conn_section]() mutable {
+			auto& arena = worker_arena(threads.size());
+			threads.emplace_back(m_phase_recorder.timed(
+				trainer_phase_t::compile,
+				[&, network_section, node_section, conn_section]() mutable {
+					place_worker(network_section.begin());
 					update_inference_network_section(
+						arena,
 						current_generation,
 						network_group,
 						network_section,
 						node_section,
 						conn_section
 					);
+					mark_networks_compiled(network_section);
 				}
-			);
+			));
 
 			network_section.begin() = network_section.end();
 			node_section.begin() = node_section.end();
@@ -1698,22 +2234,37 @@ void trainer::update_inference_network_group(inference::types::network_group_t&
 		}
 	}
 	if (not network_section.empty()) {
-		threads.emplace_back([this, &current_generation, &network_group, network_section, node_section, conn_section](
-							 ) mutable {
-			update_inference_network_section(
-				current_generation,
-				network_group,
-				network_section,
-				node_section,
-				conn_section
-			);
-		});
+		auto& arena = worker_arena(threads.size());
+		threads.emplace_back(m_phase_recorder.timed(
+			trainer_phase_t::compile,
+			[&, network_section, node_section, conn_section]() mutable {
+				place_worker(network_section.begin());
+				update_inference_network_section(
+					arena,
+					current_generation,
+					network_group,
+					network_section,
+					node_section,
+					conn_section
+				);
+				mark_networks_compiled(network_section);
+			}
+		));
 	}
 
 	for (auto& thread : threads) {
 		thread.join();
 	}
 
+	auto& compile_stats = m_phase_recorder.stats().phase(trainer_phase_t::compile);
+	compile_stats.item_count = current_generation.networks.size();
+	compile_stats.bytes_touched =
+		(current_generation.networks.size() * (sizeof(types::network_t) + sizeof(inference::types::network_t)) +
+	     current_generation.connections.size() *
+	         (sizeof(types::connection_t) + sizeof(types::connection_weight_t) + sizeof(types::connection_info_t) +
+	          sizeof(inference::types::weighted_connection_t)) +
+	     network_group.incoming_connection_counts_and_node_lookups.size() * sizeof(inference::types::rel_conn_index_t));
+
 	for (const auto& network : network_group.networks) {
 		assert(
 			network.incoming_connection_count_range.end() + m_network_interface_config.output_count <=
@@ -1740,14 +2291,28 @@ void trainer::update_inference_network_group(inference::types::network_group_t&
 }
 
 void trainer::update_inference_network_section(
+	monotonic_arena& arena,
 	const types::population_t& generation,
 	inference::types::network_group_t& network_group,
 	const types::network_range_t& network_range,
 	types::conn_range_t& node_range,
 	types::conn_range_t& conn_range
 ) {
-	debug_vector<types::node_index_t> to_be_visited_nodes;
-	debug_vector<inference::types::node_index_t> eval_index_lookup;
+	if (m_evolution_config.connectivity == connectivity_t::recurrent) {
+		update_recurrent_inference_network_section(
+			arena,
+			generation,
+			network_group,
+			network_range,
+			node_range,
+			conn_range
+		);
+		return;
+	}
+
+	const auto allocator = arena_allocator<std::byte>(arena);
+	arena_vector<types::node_index_t> to_be_visited_nodes(allocator);
+	arena_vector<inference::types::node_index_t> eval_index_lookup(allocator);
 
 	const auto output_range = types::conn_range_t::from_index_count(
 		m_network_interface_config.input_count,
@@ -1774,7 +2339,7 @@ void trainer::update_inference_network_section(
 		inference_network.incoming_connection_count_range.begin() = node_range.begin();
 		inference_network.incoming_connection_count_range.clear();
 		inference_network.incoming_connections_begin = conn_range.begin();
-		assert(inference_network.incoming_connections_begin < network_group.connections.size());
+		assert(inference_network.incoming_connections_begin <= network_group.connections.size());
 
 		const auto max_node_count = m_network_interface_config.output_count + network.hidden_node_count;
 		to_be_visited_nodes.reserve(max_node_count);
@@ -1871,4 +2436,521 @@ void trainer::update_inference_network_section(
 	}
 }
 
+void trainer::update_recurrent_inference_network_section(
+	monotonic_arena& arena,
+	const types::population_t& generation,
+	inference::types::network_group_t& network_group,
+	const types::network_range_t& network_range,
+	types::conn_range_t& node_range,
+	types::conn_range_t& conn_range
+) {
+	const auto allocator = arena_allocator<std::byte>(arena);
+	arena_vector<inference::types::rel_conn_index_t> node_connection_offsets(allocator);
+
+	const auto input_count = m_network_interface_config.input_count;
+	const auto output_count = m_network_interface_config.output_count;
+
+	for (const auto& network_index : network_range.indices()) {
+
+		const auto& network = generation.networks[network_index];
+		auto& inference_network = network_group.networks[network_index];
+
+		assert(network.connections.size() <= conn_range.size());
+
+		// Unlike the feed forward networks, unreachable nodes are kept, as they might still become part of a loop.
+		const auto node_count = output_count + network.hidden_node_count;
+		inference_network.incoming_connection_count_range = inference::types::abs_conn_index_range_t::from_index_count(
+			node_range.begin(),
+			node_count
+		);
+		inference_network.incoming_connections_begin = conn_range.begin();
+
+		const auto incoming_connection_counts = inference_network.incoming_connection_count_range.span(
+			network_group.incoming_connection_counts_and_node_lookups
+		);
+		std::fill(incoming_connection_counts.begin(), incoming_connection_counts.end(), 0);
+
+		for (const auto& conn_index : network.connections.indices()) {
+			if (generation.connection_infos[conn_index].enabled) {
+				++incoming_connection_counts[generation.connections[conn_index].to - input_count];
+			}
+		}
+
+		node_connection_offsets.resize(node_count);
+		std::exclusive_scan(
+			incoming_connection_counts.begin(),
+			incoming_connection_counts.end(),
+			node_connection_offsets.begin(),
+			inference::types::rel_conn_index_t{}
+		);
+
+		// Connections keep their order inside of every node, like in the feed forward networks.
+		const auto node_connections = conn_range.span(network_group.connections);
+		for (const auto& conn_index : network.connections.indices()) {
+			if (not generation.connection_infos[conn_index].enabled) {
+				continue;
+			}
+			const auto& conn = generation.connections[conn_index];
+			node_connections[node_connection_offsets[conn.to - input_count]++] = {
+				.source_node_index = static_cast<inference::types::node_index_t>(conn.from),
+				.weight = generation.connection_weights[conn_index]
+			};
+		}
+
+		conn_range.begin() += node_count == 0 ? 0 : node_connection_offsets.back();
+
+		auto output_node_lookup_it = &network_group.incoming_connection_counts_and_node_lookups
+										  [inference_network.incoming_connection_count_range.end()];
+		for (types::node_index_t i{}; i != output_count; ++i) {
+			output_node_lookup_it[i] = input_count + i;
+		}
+
+		node_range.begin() = inference_network.incoming_connection_count_range.end() + output_count;
+		assert(node_range.begin() <= node_range.end());
+	}
+}
+
+void trainer::begin_steady_state() {
+	wait_for_generation();
+
+	const auto lock = std::lock_guard(m_steady_state_mutex);
+
+	reset_arenas();
+
+	m_steady_state_network_groups.resize(m_population_size);
+	m_steady_state_fitness.assign(m_population_size, types::fitness_t{});
+	m_steady_state_network_states.assign(m_population_size, network_state_t::pending);
+
+	// Networks are handed out from the back, so they are evaluated in order.
+	m_pending_networks.resize(m_population_size);
+	std::iota(m_pending_networks.rbegin(), m_pending_networks.rend(), types::network_index_t{});
+
+	m_evaluated_networks.clear();
+	m_evaluated_networks.reserve(m_population_size);
+	m_replacement_count = 0;
+	m_unused_connection_count = 0;
+
+	while (m_steady_state_workspaces.size() < m_thread_count) {
+		m_steady_state_workspaces.push_back(std::make_unique<steady_state_workspace_t>());
+	}
+
+	// Every network is compiled into its own group, so it can be replaced without touching the others.
+	const auto& population = m_populations[m_current_generation_index];
+
+	arena_vector<std::thread> threads{ arena_allocator<std::thread>(m_arena) };
+	threads.reserve(m_thread_count);
+
+	const auto population_range = types::network_range_t::from_index_count(0, m_population_size);
+	for (const auto& network_segment : population_range.balanced_segments(m_thread_count)) {
+		auto& workspace = *m_steady_state_workspaces[threads.size()];
+		threads.emplace_back([&, network_segment]() {
+			place_worker(network_segment.begin());
+
+			auto& single_network = workspace.offspring;
+			for (const auto& network_index : network_segment.indices()) {
+				const auto& network = population.networks[network_index];
+
+				const auto copy_connection_data = [&](const auto& src, auto& dst) {
+					const auto data = network.connections.cspan(src);
+					dst.assign(data.begin(), data.end());
+				};
+
+				single_network.networks.assign(
+					1,
+					{ .hidden_node_count = network.hidden_node_count,
+					  .connections = types::conn_range_t::from_index_count(0, network.connections.size()) }
+				);
+				copy_connection_data(population.connections, single_network.connections);
+				copy_connection_data(population.connection_weights, single_network.connection_weights);
+				copy_connection_data(population.connection_infos, single_network.connection_infos);
+
+				compile_steady_state_offspring(workspace, m_steady_state_network_groups[network_index]);
+			}
+		});
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+std::optional<trainer::steady_state_network_t> trainer::acquire_network() {
+	const auto lock = std::lock_guard(m_steady_state_mutex);
+
+	if (m_pending_networks.empty()) {
+		return std::nullopt;
+	}
+
+	const auto network_index = m_pending_networks.back();
+	m_pending_networks.pop_back();
+	m_steady_state_network_states[network_index] = network_state_t::evaluating;
+
+	return steady_state_network_t{ .index = network_index,
+		                           .network_group = &m_steady_state_network_groups[network_index] };
+}
+
+std::optional<trainer::steady_state_network_t> trainer::report_fitness(
+	const types::network_index_t network_index, const types::fitness_t fitness
+) {
+	auto lock = std::unique_lock(m_steady_state_mutex);
+
+	assert(m_steady_state_network_states[network_index] == network_state_t::evaluating);
+	m_steady_state_fitness[network_index] = fitness;
+	m_steady_state_network_states[network_index] = network_state_t::evaluated;
+	m_evaluated_networks.emplace_back(fitness, network_index);
+	std::push_heap(m_evaluated_networks.begin(), m_evaluated_networks.end(), std::greater{});
+
+	// The replaced network and at least two parents have to be evaluated.
+	const auto min_evaluated_count = std::max(
+		std::size_t{ 3 },
+		static_cast<std::size_t>(std::ceil(
+			m_evolution_config.steady_state_config.min_evaluated_portion * static_cast<float>(m_population_size)
+		))
+	);
+
+	if (m_evaluated_networks.size() < min_evaluated_count) {
+		lock.unlock();
+		return acquire_network();
+	}
+
+	std::pop_heap(m_evaluated_networks.begin(), m_evaluated_networks.end(), std::greater{});
+	const auto replaced_index = m_evaluated_networks.back().second;
+	m_evaluated_networks.pop_back();
+
+	// The replaced network can't become a parent anymore, and its group is only written by this thread.
+	m_steady_state_network_states[replaced_index] = network_state_t::evaluating;
+
+	const auto generation = ++m_generation_count;
+
+	if (m_steady_state_workspaces.empty()) {
+		m_steady_state_workspaces.push_back(std::make_unique<steady_state_workspace_t>());
+	}
+	auto workspace = std::move(m_steady_state_workspaces.back());
+	m_steady_state_workspaces.pop_back();
+
+	select_steady_state_parents(*workspace, generation);
+
+	lock.unlock();
+
+	create_steady_state_offspring(*workspace, generation);
+	compile_steady_state_offspring(*workspace, m_steady_state_network_groups[replaced_index]);
+
+	lock.lock();
+
+	store_steady_state_offspring(*workspace, replaced_index);
+	m_steady_state_workspaces.push_back(std::move(workspace));
+
+	// Innovation numbers are only shared between networks created close to each other, like in one generation.
+	if (++m_replacement_count % m_population_size == 0) {
+		m_conn_lookup.clear();
+	}
+
+	return steady_state_network_t{ .index = replaced_index,
+		                           .network_group = &m_steady_state_network_groups[replaced_index] };
+}
+
+std::uint64_t trainer::steady_state_replacement_count() {
+	const auto lock = std::lock_guard(m_steady_state_mutex);
+	return m_replacement_count;
+}
+
+types::network_index_t trainer::select_steady_state_parent(
+	philox_rng& rng, const types::network_index_t excluded
+) const {
+	auto network_distrib = std::uniform_int_distribution<types::network_index_t>(0, m_population_size - 1);
+
+	const auto draw_candidate = [&]() {
+		types::network_index_t candidate;
+		do {
+			candidate = network_distrib(rng);
+		} while (m_steady_state_network_states[candidate] != network_state_t::evaluated or candidate == excluded);
+		return candidate;
+	};
+
+	auto parent = draw_candidate();
+	for (std::uint32_t i{ 1 }; i < m_evolution_config.steady_state_config.tournament_size; ++i) {
+		const auto candidate = draw_candidate();
+		if (m_steady_state_fitness[candidate] > m_steady_state_fitness[parent]) {
+			parent = candidate;
+		}
+	}
+
+	return parent;
+}
+
+void trainer::select_steady_state_parents(steady_state_workspace_t& workspace, const std::uint32_t generation) {
+	const auto& population = m_populations[m_current_generation_index];
+	auto& parents = workspace.parents;
+
+	auto rng = make_rng(generation, rng_purpose_t::sampling, 0);
+	auto chance_distrib = std::uniform_real_distribution<float>(0.0f, 1.0f);
+
+	const auto crossover = chance_distrib(rng) >= m_evolution_config.mutation_rate_config.offspring_mutation_rate;
+
+	auto parent_indices = types::parents_t{};
+	parent_indices[0] = select_steady_state_parent(rng, invalid_network_index);
+	if (crossover) {
+		parent_indices[1] = select_steady_state_parent(rng, parent_indices[0]);
+	}
+
+	parents.networks.clear();
+	parents.connections.clear();
+	parents.connection_weights.clear();
+	parents.connection_infos.clear();
+
+	for (std::size_t i{}; i != (crossover ? 2 : 1); ++i) {
+		const auto& network = population.networks[parent_indices[i]];
+
+		const auto append_connection_data = [&](const auto& src, auto& dst) {
+			const auto data = network.connections.cspan(src);
+			dst.insert(dst.end(), data.begin(), data.end());
+		};
+
+		parents.networks.push_back(
+			{ .hidden_node_count = network.hidden_node_count,
+			  .connections = types::conn_range_t::from_index_count(
+				  parents.connections.size(),
+				  network.connections.size()
+			  ) }
+		);
+		append_connection_data(population.connections, parents.connections);
+		append_connection_data(population.connection_weights, parents.connection_weights);
+		append_connection_data(population.connection_infos, parents.connection_infos);
+
+		workspace.parent_fitness[i] = m_steady_state_fitness[parent_indices[i]];
+	}
+}
+
+void trainer::create_steady_state_offspring(steady_state_workspace_t& workspace, const std::uint32_t generation) {
+	const auto& ancestors = workspace.parents;
+	auto& offspring = workspace.offspring;
+	const auto& mutation_rates = m_evolution_config.mutation_rate_config;
+
+	// The offspring is the only network of its population, so all helpers work on the range of network zero.
+	const auto offspring_range = types::network_range_t::from_index_count(0, 1);
+
+	offspring.networks.resize(1);
+	auto& offspring_network = offspring.networks.front();
+	workspace.topological_mutation = false;
+
+	if (ancestors.networks.size() == 2) {
+		const auto parents_lookup = std::array<types::parents_t, 1>{ types::parents_t{ 0, 1 } };
+
+		auto& staging = workspace.staging;
+		staging.connections.clear();
+		staging.connection_weights.clear();
+		staging.connection_infos.clear();
+		create_crossovers(
+			generation,
+			ancestors.networks,
+			ancestors.connections,
+			ancestors.connection_weights,
+			ancestors.connection_infos,
+			workspace.parent_fitness,
+			parents_lookup,
+			offspring.networks,
+			staging,
+			0,
+			offspring_range
+		);
+
+		offspring.connections.resize(staging.connections.size());
+		offspring.connection_weights.resize(staging.connections.size());
+		offspring.connection_infos.resize(staging.connections.size());
+		compact_crossovers(
+			staging,
+			0,
+			offspring.networks,
+			offspring.connections,
+			offspring.connection_weights,
+			offspring.connection_infos,
+			offspring_range
+		);
+
+		mutate_some_connections(generation, offspring.networks, offspring.connection_weights, offspring_range);
+		return;
+	}
+
+	const auto ancestor_lookup = std::array<types::network_index_t, 1>{ 0 };
+	const auto& ancestor_network = ancestors.networks.front();
+
+	// The parent selection used the first sampling stream.
+	auto rng = make_rng(generation, rng_purpose_t::sampling, 1);
+	auto chance_distrib = std::uniform_real_distribution<float>(0.0f, 1.0f);
+
+	// Same split as the generational composition, topological mutations first and weight mutations otherwise.
+	const auto mutation_chance = chance_distrib(rng);
+	const auto add_conn_mutation = mutation_chance < mutation_rates.new_connection_rate;
+	const auto add_node_mutation = not add_conn_mutation and
+		mutation_chance < mutation_rates.new_connection_rate + mutation_rates.new_node_rate;
+
+	const auto added_connection_count = add_conn_mutation ? 1 : (add_node_mutation ? 2 : 0);
+
+	offspring_network.hidden_node_count = ancestor_network.hidden_node_count + (add_node_mutation ? 1 : 0);
+	offspring_network.connections = types::conn_range_t::from_index_count(
+		0,
+		ancestor_network.connections.size() + added_connection_count
+	);
+
+	offspring.connections.resize(offspring_network.connections.size());
+	offspring.connection_weights.resize(offspring_network.connections.size());
+	offspring.connection_infos.resize(offspring_network.connections.size());
+
+	copy_connection_data<types::connection_t>(
+		ancestor_lookup,
+		ancestors.networks,
+		offspring.networks,
+		ancestors.connections,
+		offspring.connections,
+		offspring_range
+	);
+	copy_connection_data<types::connection_weight_t>(
+		ancestor_lookup,
+		ancestors.networks,
+		offspring.networks,
+		ancestors.connection_weights,
+		offspring.connection_weights,
+		offspring_range
+	);
+	copy_connection_data<types::connection_info_t>(
+		ancestor_lookup,
+		ancestors.networks,
+		offspring.networks,
+		ancestors.connection_infos,
+		offspring.connection_infos,
+		offspring_range
+	);
+
+	if (add_conn_mutation) {
+		apply_add_conn_mutations(
+			generation,
+			ancestors.networks,
+			ancestors.connections,
+			ancestor_lookup,
+			offspring.networks,
+			offspring.connections,
+			offspring.connection_weights,
+			offspring.connection_infos,
+			workspace.sampler,
+			offspring_range
+		);
+	} else if (add_node_mutation) {
+		apply_add_node_mutations(
+			generation,
+			ancestors.networks,
+			ancestors.connections,
+			ancestors.connection_weights,
+			ancestor_lookup,
+			offspring.networks,
+			offspring.connections,
+			offspring.connection_weights,
+			offspring.connection_infos,
+			offspring_range
+		);
+	} else {
+		mutate_all_connections(generation, offspring.networks, offspring.connection_weights, offspring_range);
+		return;
+	}
+
+	workspace.topological_mutation = true;
+	mutate_some_connections(generation, offspring.networks, offspring.connection_weights, offspring_range);
+}
+
+void trainer::store_steady_state_offspring(
+	steady_state_workspace_t& workspace, const types::network_index_t replaced_index
+) {
+	auto& offspring = workspace.offspring;
+	if (workspace.topological_mutation) {
+		const auto ancestor_lookup = std::array<types::network_index_t, 1>{ 0 };
+		assign_innovation_numbers(
+			workspace.parents.networks,
+			ancestor_lookup,
+			offspring.networks,
+			offspring.connections,
+			offspring.connection_infos,
+			types::network_range_t::from_index_count(0, 1)
+		);
+	}
+
+	auto& population = m_populations[m_current_generation_index];
+	const auto& offspring_network = offspring.networks.front();
+	auto& network = population.networks[replaced_index];
+
+	m_unused_connection_count += network.connections.size();
+
+	// The offspring is appended, as it rarely has the same size as the network it replaces.
+	network.hidden_node_count = offspring_network.hidden_node_count;
+	network.connections = types::conn_range_t::from_index_count(
+		population.connections.size(),
+		offspring_network.connections.size()
+	);
+
+	const auto append_connection_data = [&](const auto& src, auto& dst) {
+		const auto data = offspring_network.connections.cspan(src);
+		dst.insert(dst.end(), data.begin(), data.end());
+	};
+	append_connection_data(offspring.connections, population.connections);
+	append_connection_data(offspring.connection_weights, population.connection_weights);
+	append_connection_data(offspring.connection_infos, population.connection_infos);
+
+	if (m_unused_connection_count <= population.connections.size() / 2) {
+		return;
+	}
+
+	// The other population buffer is only needed by the generational mode, so it is borrowed for the compaction.
+	auto& compacted = m_populations[(m_current_generation_index + 1) % m_populations.size()];
+	compacted.connections.clear();
+	compacted.connection_weights.clear();
+	compacted.connection_infos.clear();
+
+	for (auto& population_network : population.networks) {
+		const auto compact_connection_data = [&](const auto& src, auto& dst) {
+			const auto data = population_network.connections.cspan(src);
+			dst.insert(dst.end(), data.begin(), data.end());
+		};
+		const auto compacted_begin = compacted.connections.size();
+		compact_connection_data(population.connections, compacted.connections);
+		compact_connection_data(population.connection_weights, compacted.connection_weights);
+		compact_connection_data(population.connection_infos, compacted.connection_infos);
+		population_network.connections = types::conn_range_t::from_index_count(
+			compacted_begin,
+			population_network.connections.size()
+		);
+	}
+
+	std::swap(population.connections, compacted.connections);
+	std::swap(population.connection_weights, compacted.connection_weights);
+	std::swap(population.connection_infos, compacted.connection_infos);
+
+	m_unused_connection_count = 0;
+}
+
+void trainer::compile_steady_state_offspring(
+	steady_state_workspace_t& workspace, inference::types::network_group_t& network_group
+) {
+	const auto& network = workspace.offspring.networks.front();
+
+	network_group.networks.resize(1);
+	network_group.incoming_connection_counts_and_node_lookups.resize(
+		2 * m_network_interface_config.output_count + network.hidden_node_count
+	);
+	network_group.connections.resize(network.connections.size());
+
+	auto node_range = types::conn_range_t::from_index_count(
+		0,
+		network_group.incoming_connection_counts_and_node_lookups.size()
+	);
+	auto conn_range = types::conn_range_t::from_index_count(0, network_group.connections.size());
+
+	workspace.arena.reset();
+	update_inference_network_section(
+		workspace.arena,
+		workspace.offspring,
+		network_group,
+		types::network_range_t::from_index_count(0, 1),
+		node_range,
+		conn_range
+	);
+}
+
 } // namespace neat
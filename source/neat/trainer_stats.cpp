@@ -0,0 +1,119 @@
+#include "neat/trainer_stats.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace neat {
+
+std::string_view phase_name(const trainer_phase_t phase) {
+	switch (phase) {
+	case trainer_phase_t::calc_species_fitness:
+		return "calc_species_fitness";
+	case trainer_phase_t::divide_offspring:
+		return "divide_offspring";
+	case trainer_phase_t::sampling:
+		return "sampling";
+	case trainer_phase_t::copying:
+		return "copying";
+	case trainer_phase_t::crossover:
+		return "crossover";
+	case trainer_phase_t::mutation:
+		return "mutation";
+	case trainer_phase_t::reproduction:
+		return "reproduction";
+	case trainer_phase_t::speciation:
+		return "speciation";
+	case trainer_phase_t::compile:
+		return "compile";
+	case trainer_phase_t::serial:
+		return "serial";
+	case trainer_phase_t::count:
+		break;
+	}
+	return "unknown";
+}
+
+std::chrono::nanoseconds phase_stats_t::total_busy_time() const {
+	return std::accumulate(worker_busy_times.begin(), worker_busy_times.end(), std::chrono::nanoseconds{});
+}
+
+std::chrono::nanoseconds phase_stats_t::max_busy_time() const {
+	const auto max_it = std::max_element(worker_busy_times.begin(), worker_busy_times.end());
+	return max_it == worker_busy_times.end() ? std::chrono::nanoseconds{} : *max_it;
+}
+
+const phase_stats_t& generation_stats_t::phase(const trainer_phase_t phase) const {
+	return phases[static_cast<std::size_t>(phase)];
+}
+
+phase_stats_t& generation_stats_t::phase(const trainer_phase_t phase) {
+	return phases[static_cast<std::size_t>(phase)];
+}
+
+static void write_json(std::ostream& out, const spin_lock_stats_t& stats) {
+	out << "{\"acquisitions\":" << stats.acquisitions << ",\"failed_attempts\":" << stats.failed_attempts
+		<< ",\"spin_time_ns\":" << stats.spin_time.count() << '}';
+}
+
+void write_json(std::ostream& out, const generation_stats_t& stats) {
+	const auto& composition = stats.composition;
+
+	out << "{\"generation\":" << stats.generation_index << ",\"wall_time_ns\":" << stats.wall_time.count()
+		<< ",\"species_count\":" << stats.species_count << ",\"composition\":{"
+		<< "\"add_conn_mutation_count\":" << composition.add_conn_mutation_count
+		<< ",\"add_node_mutation_count\":" << composition.add_node_mutation_count
+		<< ",\"conn_mutation_count\":" << composition.conn_mutation_count
+		<< ",\"champion_count\":" << composition.champion_count
+		<< ",\"crossover_count\":" << composition.crossover_count << "},\"phases\":{";
+
+	for (std::size_t i{}; i != trainer_phase_count; ++i) {
+		const auto phase = static_cast<trainer_phase_t>(i);
+		const auto& phase_stats = stats.phase(phase);
+
+		if (i != 0) {
+			out << ',';
+		}
+		out << '"' << phase_name(phase) << "\":{\"wall_time_ns\":" << phase_stats.wall_time.count()
+			<< ",\"worker_busy_times_ns\":[";
+		for (std::size_t j{}; j != phase_stats.worker_busy_times.size(); ++j) {
+			if (j != 0) {
+				out << ',';
+			}
+			out << phase_stats.worker_busy_times[j].count();
+		}
+		out << "],\"item_count\":" << phase_stats.item_count << ",\"bytes_touched\":" << phase_stats.bytes_touched
+			<< ",\"migrated_worker_count\":" << phase_stats.migrated_worker_count << '}';
+	}
+
+	out << "},\"locks\":{\"telemetry_enabled\":" << (spin_lock_telemetry_enabled ? "true" : "false")
+		<< ",\"connection_lookup\":";
+	write_json(out, stats.lock_stats.connection_lookup);
+	out << ",\"species_lookup\":";
+	write_json(out, stats.lock_stats.species_lookup);
+	out << ",\"species_buckets\":";
+	write_json(out, stats.lock_stats.species_buckets);
+	out << "},\"arena\":{\"upstream_allocation_count\":" << stats.arena.upstream_allocation_count
+		<< ",\"bytes_used\":" << stats.arena.bytes_used << ",\"capacity\":" << stats.arena.capacity
+		<< "},\"placement\":{\"numa_node_count\":" << stats.placement.numa_node_count
+		<< ",\"worker_cpu_count\":" << stats.placement.worker_cpu_count
+		<< ",\"pinned\":" << (stats.placement.pinned ? "true" : "false")
+		<< ",\"failed_placement_count\":" << stats.placement.failed_placement_count << "}}";
+}
+
+void write_csv_header(std::ostream& out) {
+	out << "generation,phase,wall_time_ns,worker_count,total_busy_time_ns,max_busy_time_ns,item_count,bytes_touched,"
+		   "migrated_worker_count\n";
+}
+
+void write_csv(std::ostream& out, const generation_stats_t& stats) {
+	for (std::size_t i{}; i != trainer_phase_count; ++i) {
+		const auto phase = static_cast<trainer_phase_t>(i);
+		const auto& phase_stats = stats.phase(phase);
+		out << stats.generation_index << ',' << phase_name(phase) << ',' << phase_stats.wall_time.count() << ','
+			<< phase_stats.worker_busy_times.size() << ',' << phase_stats.total_busy_time().count() << ','
+			<< phase_stats.max_busy_time().count() << ',' << phase_stats.item_count << ','
+			<< phase_stats.bytes_touched << ',' << phase_stats.migrated_worker_count << '\n';
+	}
+}
+
+} // namespace neat